@@ -0,0 +1,106 @@
+#include "../sdl/sdl_packs.h"
+#include "bench.hpp"
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#undef main
+
+// Times a frame of sprites drawn one Texture::copy_to at a time against the same sprites drawn through a SpriteBatch,
+// on the software renderer and, when a window can be opened, on the default renderer of a hidden window.
+// usage: leap-bench-batch [sprites]
+using namespace leap;
+
+namespace {
+	constexpr int width = 1280, height = 720, size = 24, textures = 8;
+
+	struct Sprite {
+		size_t texture;
+		pos::IPoint at;
+	};
+
+	void run(const char *name, const render::Renderer &renderer, size_t count) {
+		std::vector<std::unique_ptr<texture::Texture>> atlas;
+		for (int i = 0; i < textures; ++i) {
+			SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_ARGB8888);
+			if (surface == nullptr)
+				except::throw_exc();
+			const surface::Surface owner(surface);
+			SDL_FillRect(surface, nullptr, SDL_MapRGBA(surface->format, 40 * i, 255 - 30 * i, 128, 200));
+			atlas.push_back(std::make_unique<texture::Texture>(renderer.convert(surface)));
+			atlas.back()->set_blend_mode(SDL_BLENDMODE_BLEND);
+		}
+
+		// textures interleaved the way a HUD submits them, which defeats merging consecutive sprites
+		std::mt19937 generator(11);
+		std::vector<Sprite> sprites(count);
+		for (auto &sprite : sprites)
+			sprite = {generator() % textures, {static_cast<int>(generator() % (width - size)),
+			                                   static_cast<int>(generator() % (height - size))}};
+
+		char label[96];
+		const auto frame = [&](const char *how, auto &&draw) {
+			std::snprintf(label, sizeof(label), "%s %s, %zu sprites", name, how, count);
+			bench::report(label, bench::best_ms([&] {
+				renderer.clear();
+				draw();
+				renderer.present();
+			}, 15), static_cast<double>(count), "sprites");
+		};
+
+		frame("copy_to", [&] {
+			for (const auto &sprite : sprites)
+				atlas[sprite.texture]->copy_to(renderer, sprite.at);
+		});
+
+		batch::SpriteBatch sprite_batch;
+		const auto batched = [&](batch::SpriteBatch::SortMode sort) {
+			sprite_batch.set_sort_mode(sort);
+			for (const auto &sprite : sprites)
+				sprite_batch.draw(*atlas[sprite.texture], pos::FPoint(static_cast<float>(sprite.at.x), static_cast<float>(sprite.at.y)));
+			sprite_batch.flush(renderer);
+		};
+		frame("SpriteBatch deferred", [&] { batched(batch::SpriteBatch::SortMode::deferred); });
+		std::printf("    %zu draw calls\n", sprite_batch.draw_calls());
+		frame("SpriteBatch sorted by texture", [&] { batched(batch::SpriteBatch::SortMode::texture); });
+		std::printf("    %zu draw calls\n", sprite_batch.draw_calls());
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+
+		SDL_Surface *canvas = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+		if (canvas == nullptr)
+			except::throw_exc();
+		const surface::Surface owner(canvas);
+		{
+			SDL_Renderer *software = SDL_CreateSoftwareRenderer(canvas);
+			if (software == nullptr)
+				except::throw_exc();
+			const render::Renderer renderer(software);
+			run("software", renderer, count);
+		}
+
+		if (SDL_Init(SDL_INIT_VIDEO) == 0) {
+			const render::Window window("leap-bench-batch", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+			                            width, height, SDL_WINDOW_HIDDEN);
+			if (window.get() != nullptr) {
+				const render::Renderer renderer(window, -1, SDL_RENDERER_ACCELERATED);
+				if (renderer.get() != nullptr) {
+					SDL_RendererInfo info;
+					SDL_GetRendererInfo(renderer.get(), &info);
+					run(info.name, renderer, count);
+				}
+			}
+			SDL_Quit();
+		}
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
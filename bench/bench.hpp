@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+
+// Timing for the benchmark programs, which print one line per measurement.
+namespace bench {
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * \brief runs \c function \c rounds times
+	 * \return the fastest run in milliseconds, the least disturbed by other work
+	 */
+	template <typename Function>
+	double best_ms(Function &&function, int rounds = 7) {
+		double best = 1e300;
+		for (int i = 0; i < rounds; ++i) {
+			const auto start = Clock::now();
+			function();
+			best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+		}
+		return best;
+	}
+
+	/**
+	 * \param items the number of items a run handles, to print the rate too, or 0
+	 * \param unit the name of the items
+	 */
+	inline void report(const char *name, double ms, double items = 0, const char *unit = "") {
+		if (items > 0)
+			std::printf("%-44s %10.3f ms %10.1f M%s/s\n", name, ms, items / ms / 1000, unit);
+		else
+			std::printf("%-44s %10.3f ms\n", name, ms);
+	}
+
+	/**
+	 * \brief keeps the compiler from dropping a result nobody reads
+	 */
+	template <typename Type>
+	void keep(const Type &value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void *sink;
+		sink = &value;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+	}
+}
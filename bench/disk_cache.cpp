@@ -0,0 +1,131 @@
+#include "../image/disk_cache.hpp"
+#include "bench.hpp"
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#undef main
+
+// Times loading a set of PNGs as textures the way startup does: decoding with image::load and uploading, against
+// DiskCache with no cache files (cold, which decodes and writes them) and with valid ones (warm, which maps and
+// uploads them). It runs on the software renderer and, when a window opens, on the default renderer of a hidden
+// window. Without arguments it uses 16 generated 512x512 PNGs.
+// usage: leap-bench-disk_cache [png]...
+using namespace leap;
+
+namespace {
+	namespace fs = std::filesystem;
+
+	std::vector<std::string> generated_pngs(const fs::path &directory) {
+		fs::create_directories(directory);
+		std::mt19937 generator(12);
+		std::vector<std::string> paths;
+		for (int i = 0; i < 16; ++i) {
+			SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, 512, 512, 32, SDL_PIXELFORMAT_RGBA32);
+			if (surface == nullptr)
+				except::throw_exc();
+			const surface::Surface image(surface);
+			// gradients with some noise, which compress about as well as UI art
+			for (int y = 0; y < image->h; ++y)
+				for (int x = 0; x < image->w; ++x)
+					image.row(y)[x] = 0xff000000u | static_cast<Uint32>(x / 2 + i) << 16 |
+					                  static_cast<Uint32>(y / 2) << 8 | (generator() & 0x0f);
+			paths.push_back((directory / ("image" + std::to_string(i) + ".png")).string());
+			if (IMG_SavePNG(surface, paths.back().c_str()))
+				except::throw_exc();
+		}
+		return paths;
+	}
+
+	/**
+	 * \brief the fastest of a few runs of \c function, each after \c prepare, which is not timed
+	 */
+	template <typename Prepare, typename Function>
+	double best_ms(Prepare &&prepare, Function &&function) {
+		double best = 1e300;
+		for (int i = 0; i < 5; ++i) {
+			prepare();
+			best = std::min(best, bench::best_ms(function, 1));
+		}
+		return best;
+	}
+
+	void run(const char *name, const render::Renderer &renderer, const std::vector<std::string> &paths,
+	         const fs::path &directory) {
+		char label[96];
+		const auto label_of = [&](const char *what) {
+			std::snprintf(label, sizeof(label), "%s %s, %zu images", name, what, paths.size());
+			return label;
+		};
+
+		bench::report(label_of("image::load and upload"), bench::best_ms([&] {
+			for (const auto &path : paths)
+				bench::keep(image::convert(renderer, image::load(path)));
+		}, 5));
+
+		image::DiskCache cache(renderer, directory);
+		bench::report(label_of("DiskCache cold"), best_ms([&] {
+			std::error_code error;
+			fs::remove_all(directory, error);
+		}, [&] {
+			for (const auto &path : paths)
+				bench::keep(cache.texture(renderer, path));
+		}));
+
+		const size_t misses = cache.misses();
+		bench::report(label_of("DiskCache warm"), bench::best_ms([&] {
+			for (const auto &path : paths)
+				bench::keep(cache.texture(renderer, path));
+		}, 5));
+		if (cache.misses() != misses)
+			throw except::LeapException("a warm load decoded its source");
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		image::init(IMG_INIT_PNG);
+		const fs::path scratch = fs::temp_directory_path() / "leap-bench-disk_cache";
+		std::vector<std::string> paths(argv + 1, argv + argc);
+		if (paths.empty())
+			paths = generated_pngs(scratch / "images");
+		const fs::path directory = scratch / "cache";
+
+		SDL_Surface *canvas = SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 32, SDL_PIXELFORMAT_ARGB8888);
+		if (canvas == nullptr)
+			except::throw_exc();
+		const surface::Surface owner(canvas);
+		{
+			SDL_Renderer *software = SDL_CreateSoftwareRenderer(canvas);
+			if (software == nullptr)
+				except::throw_exc();
+			const render::Renderer renderer(software);
+			run("software", renderer, paths, directory);
+		}
+
+		if (SDL_Init(SDL_INIT_VIDEO) == 0) {
+			const render::Window window("leap-bench-disk_cache", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+			                            64, 64, SDL_WINDOW_HIDDEN);
+			if (window.get() != nullptr) {
+				const render::Renderer renderer(window, -1, SDL_RENDERER_ACCELERATED);
+				if (renderer.get() != nullptr) {
+					SDL_RendererInfo info;
+					SDL_GetRendererInfo(renderer.get(), &info);
+					// the native format differs between renderers, so each starts from an empty cache
+					std::error_code error;
+					fs::remove_all(directory, error);
+					run(info.name, renderer, paths, directory);
+				}
+			}
+			SDL_Quit();
+		}
+		std::error_code error;
+		fs::remove_all(scratch, error);
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,126 @@
+#include "../sdl/sdl_packs.h"
+#include "bench.hpp"
+#include <random>
+#include <vector>
+
+#undef main
+
+// Times RectArray and PointArray, on the scalar and SSE2 paths, against loops over vectors of Rect and Point
+// calling the member functions they replace, on 50000 elements.
+using namespace leap;
+
+namespace {
+	constexpr size_t count = 50000;
+	std::mt19937 generator(19);
+
+	template <typename Arithmetic>
+	std::vector<pos::Rect<Arithmetic>> random_rects() {
+		std::vector<pos::Rect<Arithmetic>> rects(count);
+		for (auto &rect : rects)
+			rect = pos::Rect<Arithmetic>(static_cast<Arithmetic>(generator() % 4000), static_cast<Arithmetic>(generator() % 4000),
+			                             static_cast<Arithmetic>(generator() % 100), static_cast<Arithmetic>(generator() % 100));
+		return rects;
+	}
+
+	/**
+	 * \brief times \c aos on the vector of rects, then \c soa on the array on each path, as "<name> <kind>"
+	 */
+	template <typename Aos, typename Soa>
+	void compare(const char *name, Aos &&aos, Soa &&soa) {
+		char label[64];
+		std::snprintf(label, sizeof(label), "%s Rect loop", name);
+		bench::report(label, bench::best_ms(aos), count, "rects");
+		for (const auto &[isa, isa_name] : {std::pair{kernel::Isa::scalar, "scalar"}, {kernel::Isa::sse2, "sse2"}}) {
+			kernel::limit_isa(isa);
+			if (kernel::isa() != isa)
+				continue;
+			std::snprintf(label, sizeof(label), "%s RectArray %s", name, isa_name);
+			bench::report(label, bench::best_ms(soa), count, "rects");
+		}
+		kernel::limit_isa(kernel::Isa::avx2);
+	}
+
+	template <typename Arithmetic>
+	void run(const char *type) {
+		using Rect = pos::Rect<Arithmetic>;
+		using Point = pos::Point<Arithmetic>;
+		std::printf("%s\n", type);
+		const auto source = random_rects<Arithmetic>();
+		std::vector<Rect> rects = source;
+		pos::RectArray<Arithmetic> array(source);
+		std::vector<Uint8> mask(count);
+		const Point offset(3, 5), origin(2000, 2000), point(2000, 2000);
+		// read at run time, so the compiler cannot fold the multiplications away; 1 keeps repeated runs in range
+		static volatile int factor = 1;
+		const auto m = static_cast<Arithmetic>(factor);
+		const Rect probe(1500, 1500, 1000, 1000);
+
+		bench::report("assign and store RectArray", bench::best_ms([&] {
+			array.assign(rects);
+			array.store(rects);
+		}), count, "rects");
+		compare("translate", [&] {
+			for (auto &rect : rects)
+				rect = rect + offset;
+			bench::keep(rects);
+		}, [&] {
+			array.translate(offset);
+			bench::keep(array);
+		});
+		compare("expand", [&] {
+			for (auto &rect : rects)
+				rect = rect.expand(origin, m);
+			bench::keep(rects);
+		}, [&] {
+			array.expand(origin, m);
+			bench::keep(array);
+		});
+		compare("contains", [&] {
+			for (size_t i = 0; i < count; ++i)
+				mask[i] = source[i].contains(point);
+			bench::keep(mask);
+		}, [&] {
+			array.contains(point, mask);
+			bench::keep(mask);
+		});
+		compare("intersects", [&] {
+			for (size_t i = 0; i < count; ++i)
+				mask[i] = source[i].intersects(probe);
+			bench::keep(mask);
+		}, [&] {
+			array.intersects(probe, mask);
+			bench::keep(mask);
+		});
+		compare("clip", [&] {
+			rects = source;
+			for (auto &rect : rects)
+				rect = rect.intersection(probe);
+			bench::keep(rects);
+		}, [&] {
+			array.assign(source);
+			array.clip(probe);
+			bench::keep(array);
+		});
+		array.assign(source);
+		compare("bounds", [&] {
+			Rect bounds = source[0];
+			for (const auto &rect : source)
+				bounds = bounds.united(rect);
+			bench::keep(bounds);
+		}, [&] {
+			bench::keep(array.bounds());
+		});
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		run<int>("int");
+		run<float>("float");
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
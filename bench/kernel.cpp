@@ -0,0 +1,97 @@
+#include "../sdl/sdl_packs.h"
+#include "bench.hpp"
+#include <array>
+#include <random>
+#include <vector>
+
+#undef main
+
+// Times the pixel kernels on every instruction set against the SDL call they stand in for, on a 1920x1080 frame.
+using namespace leap;
+
+namespace {
+	constexpr int width = 1920, height = 1080;
+	constexpr double pixels = static_cast<double>(width) * height;
+	constexpr std::array<std::pair<kernel::Isa, const char *>, 3> isas = {{
+		{kernel::Isa::scalar, "scalar"}, {kernel::Isa::sse2, "sse2"}, {kernel::Isa::avx2, "avx2"}
+	}};
+
+	surface::Surface make(Uint32 format = SDL_PIXELFORMAT_ARGB8888) {
+		SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, format);
+		if (surface == nullptr)
+			except::throw_exc();
+		surface::Surface result(surface);
+		std::mt19937 generator(7);
+		for (int y = 0; y < height; ++y)
+			for (int x = 0; x < width; ++x)
+				result.row(y)[x] = generator();
+		return result;
+	}
+
+	/**
+	 * \brief times \c function once per instruction set the machine has, as "<name> <isa>"
+	 */
+	template <typename Function>
+	void per_isa(const char *name, Function &&function) {
+		char label[64];
+		for (const auto &[isa, isa_name] : isas) {
+			kernel::limit_isa(isa);
+			if (kernel::isa() != isa)
+				continue;
+			std::snprintf(label, sizeof(label), "%s %s", name, isa_name);
+			bench::report(label, bench::best_ms(function), pixels, "px");
+		}
+		kernel::limit_isa(kernel::Isa::avx2);
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		auto src = make(), dst = make();
+		if (SDL_SetSurfaceBlendMode(src.get(), SDL_BLENDMODE_BLEND))
+			except::throw_exc();
+
+		bench::report("fill SDL_FillRect", bench::best_ms([&] {
+			SDL_FillRect(dst.get(), nullptr, 0xff336699);
+		}), pixels, "px");
+		per_isa("fill", [&] {
+			for (int y = 0; y < height; ++y)
+				kernel::fill(dst.row(y), width, 0xff336699);
+		});
+
+		bench::report("blend SDL_BlitSurface", bench::best_ms([&] {
+			SDL_BlitSurface(src.get(), nullptr, dst.get(), nullptr);
+		}), pixels, "px");
+		per_isa("blend", [&] {
+			for (int y = 0; y < height; ++y)
+				kernel::blend(dst.row(y), src.row(y), width);
+		});
+
+		bench::report("convert SDL_ConvertSurfaceFormat", bench::best_ms([&] {
+			SDL_FreeSurface(SDL_ConvertSurfaceFormat(src.get(), SDL_PIXELFORMAT_ABGR8888, 0));
+		}), pixels, "px");
+		kernel::Swizzle swizzle;
+		kernel::make_swizzle(SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888, swizzle);
+		per_isa("convert", [&] {
+			for (int y = 0; y < height; ++y)
+				kernel::swizzle(dst.row(y), src.row(y), width, swizzle);
+		});
+
+		bench::report("premultiply SDL_PremultiplyAlpha", bench::best_ms([&] {
+			SDL_PremultiplyAlpha(width, height, SDL_PIXELFORMAT_ARGB8888, src->pixels, src->pitch,
+			                     SDL_PIXELFORMAT_ARGB8888, dst->pixels, dst->pitch);
+		}), pixels, "px");
+		per_isa("premultiply", [&] {
+			for (int y = 0; y < height; ++y) {
+				std::copy(src.row(y), src.row(y) + width, dst.row(y));
+				kernel::premultiply(dst.row(y), width);
+			}
+		});
+		bench::keep(dst->pixels);
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,208 @@
+#include "../sdl/sdl_packs.h"
+#include "bench.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#undef main
+
+// Compares three ways for worker threads to hand results to the thread waiting in SDL_WaitEventTimeout:
+// one SDL_PushEvent per message with the message on the heap, a mutex-guarded deque, and event::Mailbox. The
+// last two push one SDL event per batch. Throughput is timed for 1 to 8 producers, and latency for one producer
+// posting every 50 us, from posting to handling through a real wake-up.
+// The contention this is about only shows with one core per producer; on fewer cores the producers mostly take
+// turns, which favors the mutex.
+// usage: leap-bench-mailbox [max producers]
+using namespace leap;
+
+namespace {
+	using Clock = bench::Clock;
+
+	struct Message {
+		Clock::time_point sent;
+		size_t producer = 0;
+		size_t sequence = 0;
+	};
+
+	/**
+	 * \brief the message on the heap and one SDL event per message, the way to do it without a mailbox
+	 */
+	class Pushed {
+		Uint32 type_ = SDL_RegisterEvents(1);
+
+	public:
+		bool post(const Message &message) {
+			SDL_Event event{};
+			event.type = type_;
+			event.user.data1 = new Message(message);
+			if (SDL_PushEvent(&event) > 0)
+				return true;
+			delete static_cast<Message *>(event.user.data1);
+			return false;
+		}
+
+		template <typename Function>
+		void handle(const SDL_Event &event, Function &&function) {
+			if (event.type != type_)
+				return;
+			const std::unique_ptr<Message> message(static_cast<Message *>(event.user.data1));
+			function(*message);
+		}
+	};
+
+	/**
+	 * \brief a mutex-guarded deque, announced once per batch like Mailbox
+	 */
+	class Locked {
+		Uint32 type_ = SDL_RegisterEvents(1);
+		std::mutex mutex_;
+		std::deque<Message> messages_, taken_;
+		std::atomic<bool> notified_{false};
+
+	public:
+		bool post(const Message &message) {
+			{
+				std::lock_guard lock(mutex_);
+				messages_.push_back(message);
+			}
+			if (!notified_.exchange(true, std::memory_order_acq_rel)) {
+				SDL_Event event{};
+				event.type = type_;
+				if (SDL_PushEvent(&event) <= 0)
+					notified_.store(false, std::memory_order_release);
+			}
+			return true;
+		}
+
+		template <typename Function>
+		void handle(const SDL_Event &event, Function &&function) {
+			if (event.type != type_)
+				return;
+			notified_.exchange(false, std::memory_order_acq_rel);
+			{
+				std::lock_guard lock(mutex_);
+				taken_.swap(messages_);
+			}
+			for (const auto &message : taken_)
+				function(message);
+			taken_.clear();
+		}
+	};
+
+	class Boxed {
+		event::Mailbox<Message> mailbox_{4096};
+
+	public:
+		bool post(const Message &message) {
+			return mailbox_.post(message);
+		}
+
+		template <typename Function>
+		void handle(const SDL_Event &event, Function &&function) {
+			if (event.type == mailbox_.event_type())
+				mailbox_.drain(function);
+		}
+	};
+
+	/**
+	 * \brief runs \c producers threads posting \c per_producer messages each through a fresh \c Channel, retrying
+	 * while it is full, and handles them on this thread until all arrived
+	 * \param interval the time between two posts of a producer, or zero to post as fast as possible
+	 * \return the latency of each message in microseconds, and the time until the last one arrived
+	 */
+	template <typename Channel>
+	std::pair<std::vector<double>, double> run(size_t producers, size_t per_producer, Clock::duration interval) {
+		Channel channel;
+		std::atomic<bool> start{false};
+		std::vector<std::thread> threads;
+		for (size_t p = 0; p < producers; ++p) {
+			threads.emplace_back([&, p] {
+				while (!start.load(std::memory_order_acquire))
+					std::this_thread::yield();
+				auto next = Clock::now();
+				for (size_t i = 0; i < per_producer; ++i) {
+					if (interval != Clock::duration::zero()) {
+						next += interval;
+						while (Clock::now() < next)
+							;
+					}
+					while (!channel.post(Message{Clock::now(), p, i}))
+						std::this_thread::yield();
+				}
+			});
+		}
+
+		const size_t total = producers * per_producer;
+		std::vector<double> latencies;
+		latencies.reserve(total);
+		std::vector<size_t> expected(producers, 0);
+		bool ordered = true;
+		const auto began = Clock::now();
+		start.store(true, std::memory_order_release);
+		SDL_Event event;
+		while (latencies.size() < total) {
+			if (!SDL_WaitEventTimeout(&event, 100))
+				continue;
+			channel.handle(event, [&](const Message &message) {
+				latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - message.sent).count());
+				ordered = ordered && message.sequence == expected[message.producer]++;
+			});
+		}
+		const double ms = std::chrono::duration<double, std::milli>(Clock::now() - began).count();
+		for (auto &thread : threads)
+			thread.join();
+		if (!ordered)
+			throw except::LeapException("messages of a producer arrived out of order");
+		return {std::move(latencies), ms};
+	}
+
+	template <typename Channel>
+	void throughput(const char *name, size_t producers) {
+		constexpr size_t total = 1 << 20;
+		const size_t per_producer = total / producers;
+		double best = 1e300;
+		for (int round = 0; round < 3; ++round)
+			best = std::min(best, run<Channel>(producers, per_producer, Clock::duration::zero()).second);
+		char label[64];
+		std::snprintf(label, sizeof(label), "%s, %zu producers", name, producers);
+		bench::report(label, best, static_cast<double>(per_producer * producers), "msg");
+	}
+
+	template <typename Channel>
+	void latency(const char *name) {
+		auto latencies = run<Channel>(1, 20000, std::chrono::microseconds(50)).first;
+		std::sort(latencies.begin(), latencies.end());
+		const auto at = [&latencies](double fraction) {
+			return latencies[static_cast<size_t>(fraction * static_cast<double>(latencies.size() - 1))];
+		};
+		std::printf("%-44s p50 %8.1f us  p99 %8.1f us  max %8.1f us\n", name, at(0.5), at(0.99), latencies.back());
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		if (SDL_Init(SDL_INIT_EVENTS))
+			except::throw_exc();
+		const size_t max_producers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+		std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+
+		for (size_t producers = 1; producers <= max_producers; producers *= 2) {
+			throughput<Pushed>("SDL_PushEvent", producers);
+			throughput<Locked>("mutex deque", producers);
+			throughput<Boxed>("Mailbox", producers);
+		}
+		latency<Pushed>("latency SDL_PushEvent");
+		latency<Locked>("latency mutex deque");
+		latency<Boxed>("latency Mailbox");
+		SDL_Quit();
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
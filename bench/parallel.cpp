@@ -0,0 +1,81 @@
+#include "../sdl/sdl_packs.h"
+#include "bench.hpp"
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#undef main
+
+// Times the parallel surface operations on 3840x2160 ARGB8888 surfaces for pools of 1 to 16 workers, against SDL
+// on one thread. The calling thread runs a band as well, so a pool of n workers keeps n + 1 threads busy; the
+// speedup is relative to a pool of one worker. Scaling can only show on a machine with as many cores.
+// usage: leap-bench-parallel [max workers]
+using namespace leap;
+
+namespace {
+	constexpr int width = 3840, height = 2160;
+	constexpr double pixels = static_cast<double>(width) * height;
+
+	surface::Surface make(int w, int h) {
+		SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+		if (surface == nullptr)
+			except::throw_exc();
+		surface::Surface result(surface);
+		std::mt19937 generator(3);
+		for (int y = 0; y < h; ++y)
+			for (int x = 0; x < w; ++x)
+				result.row(y)[x] = generator();
+		return result;
+	}
+
+	void speedup(const char *name, size_t workers, double ms, double single) {
+		char label[64];
+		std::snprintf(label, sizeof(label), "%s, %zu workers", name, workers);
+		std::printf("%-44s %10.3f ms %10.1f Mpx/s %6.2fx\n", label, ms, pixels / ms / 1000, single / ms);
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		const size_t max_workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+		std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+
+		auto src = make(width, height), dst = make(width, height), small = make(width / 2, height / 2);
+		if (SDL_SetSurfaceBlendMode(src.get(), SDL_BLENDMODE_BLEND))
+			except::throw_exc();
+		const SDL_Color color{51, 102, 153, 255};
+
+		bench::report("fill SDL", bench::best_ms([&] { dst.fill(color); }), pixels, "px");
+		bench::report("blit SDL", bench::best_ms([&] { dst.blit(src, pos::IPoint(0, 0)); }), pixels, "px");
+		bench::report("scale SDL_SoftStretch", bench::best_ms([&] {
+			SDL_Rect target{0, 0, width, height};
+			SDL_SoftStretch(small.get(), nullptr, dst.get(), &target);
+		}), pixels, "px");
+		bench::report("convert SDL", bench::best_ms([&] {
+			SDL_FreeSurface(src.convert(SDL_PIXELFORMAT_ABGR8888));
+		}), pixels, "px");
+
+		double single[4] = {};
+		for (size_t workers = 1; workers <= max_workers; workers *= 2) {
+			worker::WorkerPool pool(workers);
+			const double times[4] = {
+				bench::best_ms([&] { parallel::fill(pool, dst, color); }),
+				bench::best_ms([&] { parallel::blit(pool, dst, src, pos::IPoint(0, 0)); }),
+				bench::best_ms([&] { parallel::scale(pool, dst, small); }),
+				bench::best_ms([&] { SDL_FreeSurface(parallel::convert(pool, src, SDL_PIXELFORMAT_ABGR8888)); })
+			};
+			const char *names[4] = {"fill", "blit", "scale", "convert"};
+			for (int i = 0; i < 4; ++i) {
+				if (workers == 1)
+					single[i] = times[i];
+				speedup(names[i], workers, times[i], single[i]);
+			}
+		}
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
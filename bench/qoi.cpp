@@ -0,0 +1,72 @@
+#include "../image/image.hpp"
+#include "bench.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#undef main
+
+// Times decoding images from memory with IMG_Load_RW against decode_qoi on the same pixels, and encode_qoi.
+// Without arguments it uses a generated 1024x1024 image, half gradients and half noise, saved as PNG.
+// usage: leap-bench-qoi [image]...
+using namespace leap;
+
+namespace {
+	std::vector<char> read(const std::string &path) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			throw except::LeapException("cannot read " + path);
+		return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+	}
+
+	std::string generated_png() {
+		SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, 1024, 1024, 32, SDL_PIXELFORMAT_RGBA32);
+		if (surface == nullptr)
+			except::throw_exc();
+		const surface::Surface image(surface);
+		std::mt19937 generator(5);
+		for (int y = 0; y < image->h; ++y)
+			for (int x = 0; x < image->w; ++x)
+				image.row(y)[x] = y < image->h / 2 ? 0xff000000u | static_cast<Uint32>(x / 4) << 8 | static_cast<Uint32>(y / 2)
+				                                   : static_cast<Uint32>(generator());
+		const auto path = (std::filesystem::temp_directory_path() / "leap-bench-qoi.png").string();
+		if (IMG_SavePNG(surface, path.c_str()))
+			except::throw_exc();
+		return path;
+	}
+
+	void run(const std::string &path) {
+		const auto file = read(path);
+		const auto load = [&file] {
+			SDL_Surface *surface = IMG_Load_RW(SDL_RWFromConstMem(file.data(), static_cast<int>(file.size())), 1);
+			if (surface == nullptr)
+				except::throw_exc();
+			return surface::Surface(surface);
+		};
+		const auto image = load();
+		const auto qoi = image::encode_qoi(image);
+		const double pixels = static_cast<double>(image->w) * image->h;
+
+		std::printf("%s: %dx%d, %zu bytes, %zu bytes as QOI\n", path.c_str(), image->w, image->h, file.size(), qoi.size());
+		bench::report("  IMG_Load_RW", bench::best_ms([&] { bench::keep(load()); }), pixels, "px");
+		bench::report("  decode_qoi", bench::best_ms([&] { bench::keep(image::decode_qoi(qoi)); }), pixels, "px");
+		bench::report("  encode_qoi", bench::best_ms([&] { bench::keep(image::encode_qoi(image)); }), pixels, "px");
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		image::init(IMG_INIT_PNG);
+		if (argc < 2)
+			run(generated_png());
+		for (int i = 1; i < argc; ++i)
+			run(argv[i]);
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
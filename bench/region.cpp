@@ -0,0 +1,70 @@
+#include "../sdl/sdl_packs.h"
+#include "bench.hpp"
+#include <random>
+#include <vector>
+
+#undef main
+
+// Times building regions from thousands of random rectangles of a 1920x1080 screen, the operations between two of
+// them, and the queries a damage or culling pass makes.
+using namespace leap;
+
+namespace {
+	std::mt19937 generator(21);
+
+	std::vector<pos::IRect> random_rects(size_t n, int largest) {
+		std::vector<pos::IRect> rects(n);
+		for (auto &rect : rects)
+			rect = {static_cast<int>(generator() % 1920), static_cast<int>(generator() % 1080),
+			        1 + static_cast<int>(generator() % largest), 1 + static_cast<int>(generator() % largest)};
+		return rects;
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		char label[64];
+		for (const size_t n : {100, 1000, 5000}) {
+			for (const int largest : {16, 200}) {
+				const auto a = random_rects(n, largest), b = random_rects(n, largest);
+				const auto label_of = [&](const char *what) {
+					std::snprintf(label, sizeof(label), "%s, %zu rects up to %d", what, n, largest);
+					return label;
+				};
+
+				bench::report(label_of("build"), bench::best_ms([&] { bench::keep(pos::Region(a)); }),
+				              static_cast<double>(n), "rects");
+				const pos::Region ra(a), rb(b);
+				std::printf("    %zu and %zu disjoint rects\n", ra.size(), rb.size());
+				bench::report(label_of("union"), bench::best_ms([&] { bench::keep(ra | rb); }));
+				bench::report(label_of("intersection"), bench::best_ms([&] { bench::keep(ra & rb); }));
+				bench::report(label_of("subtract"), bench::best_ms([&] { bench::keep(ra - rb); }));
+
+				const auto probes = random_rects(10000, largest);
+				bench::report(label_of("intersects, 10000 probes"), bench::best_ms([&] {
+					size_t hits = 0;
+					for (const auto &probe : probes)
+						hits += ra.intersects(probe);
+					bench::keep(hits);
+				}), 10000, "probes");
+				bench::report(label_of("contains, 10000 probes"), bench::best_ms([&] {
+					size_t hits = 0;
+					for (const auto &probe : probes)
+						hits += ra.contains(probe.left_up());
+					bench::keep(hits);
+				}), 10000, "probes");
+				bench::report(label_of("iterate"), bench::best_ms([&] {
+					long long area = 0;
+					for (const auto &rect : ra)
+						area += static_cast<long long>(rect.w) * rect.h;
+					bench::keep(area);
+				}), static_cast<double>(ra.size()), "rects");
+			}
+		}
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "../sdl/sdl_packs.h"
+#include "../sdl/worker.hpp"
+#include "image.hpp"
+#include "cache.hpp"
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <exception>
+
+namespace leap {
+	namespace image {
+		/**
+		 * \brief decodes an image on a worker thread
+		 * \return the future of the surface, which rethrows the decoding error if any
+		 */
+		inline std::future<pointer::SurfacePtr> load_async(worker::WorkerPool &pool, const std::string &path,
+		                                                   const LoadOptions &options = {}) {
+			return pool.submit([path, options] { return convert(load(path), options); });
+		}
+
+		/**
+		 * \brief a texture being loaded by an AsyncLoader
+		 */
+		class TextureRequest {
+		public:
+			enum class State {
+				decoding,
+				// decoded, and waiting for AsyncLoader::upload
+				decoded,
+				ready,
+				failed
+			};
+
+		private:
+			std::atomic<State> state_{State::decoding};
+			std::string path_;
+			LoadOptions options_;
+			pointer::SurfacePtr surface_;
+			pointer::TexturePtr texture_;
+			std::exception_ptr error_;
+
+			friend class AsyncLoader;
+
+		public:
+			TextureRequest(std::string path, const LoadOptions &options) :
+				path_(std::move(path)), options_(options) {}
+
+			TextureRequest(const TextureRequest &) = delete;
+
+			State state() const noexcept {
+				return state_.load(std::memory_order_acquire);
+			}
+
+			bool ready() const noexcept {
+				return state() == State::ready;
+			}
+
+			bool failed() const noexcept {
+				return state() == State::failed;
+			}
+
+			/**
+			 * \return the texture, or nullptr if it is not ready yet
+			 * \throw the error of decoding or uploading if the request failed
+			 */
+			pointer::TexturePtr get() const {
+				const State state = this->state();
+				if (state == State::failed)
+					std::rethrow_exception(error_);
+				return state == State::ready ? texture_ : nullptr;
+			}
+
+			const std::string &path() const noexcept {
+				return path_;
+			}
+		};
+
+		using TextureRequestPtr = std::shared_ptr<TextureRequest>;
+
+		/**
+		 * \brief Loads textures without stalling the render thread.
+		 * \details Images are decoded, and converted as LoadOptions asks, on a worker pool. The decoded
+		 * surfaces are turned into textures by upload(), which the render thread calls once a frame with a
+		 * budget, so a burst of finished images is spread over several frames instead of causing a spike.
+		 */
+		class AsyncLoader {
+			// shared with the jobs, which may finish after the loader is destroyed
+			struct Finished {
+				std::mutex mutex;
+				std::deque<TextureRequestPtr> requests;
+			};
+
+			const render::Renderer &renderer_;
+			worker::WorkerPool &pool_;
+			std::shared_ptr<Finished> finished_;
+			std::atomic<size_t> pending_{0};
+
+		public:
+			/**
+			 * \param renderer the renderer textures are created with
+			 * \param pool the pool decoding the images, which must outlive the loader
+			 */
+			AsyncLoader(const render::Renderer &renderer, worker::WorkerPool &pool) :
+				renderer_(renderer), pool_(pool), finished_(std::make_shared<Finished>()) {}
+
+			AsyncLoader(const AsyncLoader &) = delete;
+
+			/**
+			 * \brief starts loading an image as a texture
+			 * \return the request, which becomes ready in a later call to upload()
+			 */
+			TextureRequestPtr load(const std::string &path, const LoadOptions &options = {}) {
+				auto request = std::make_shared<TextureRequest>(path, options);
+				++pending_;
+				pool_.submit([request, finished = finished_] {
+					try {
+						request->surface_ = convert(image::load(request->path_), request->options_);
+						request->state_.store(TextureRequest::State::decoded, std::memory_order_release);
+					}
+					catch (...) {
+						request->error_ = std::current_exception();
+						request->state_.store(TextureRequest::State::failed, std::memory_order_release);
+					}
+					std::lock_guard lock(finished->mutex);
+					finished->requests.push_back(request);
+				});
+				return request;
+			}
+
+			/**
+			 * \brief creates textures from decoded images, oldest first, until a budget is spent
+			 * \details at least one image is uploaded per call when any is decoded, so loading always progresses
+			 * \param time the time to spend on uploading
+			 * \param bytes the number of bytes of pixels to upload
+			 * \return the number of requests completed, including failed ones
+			 */
+			size_t upload(std::chrono::microseconds time = std::chrono::microseconds(2000),
+			              size_t bytes = 8 << 20) {
+				using clock = std::chrono::steady_clock;
+				const auto start = clock::now();
+				size_t done = 0, uploaded = 0;
+				for (;;) {
+					TextureRequestPtr request;
+					{
+						std::lock_guard lock(finished_->mutex);
+						if (finished_->requests.empty())
+							break;
+						request = std::move(finished_->requests.front());
+						finished_->requests.pop_front();
+					}
+					++done;
+					--pending_;
+					if (request->state() == TextureRequest::State::failed)
+						continue;
+
+					try {
+						request->texture_ = image::convert(renderer_, request->surface_);
+						request->texture_->set_blend_mode(request->options_.blend);
+						uploaded += static_cast<size_t>(request->surface_->get()->pitch) * request->surface_->get()->h;
+						request->state_.store(TextureRequest::State::ready, std::memory_order_release);
+					}
+					catch (...) {
+						request->error_ = std::current_exception();
+						request->state_.store(TextureRequest::State::failed, std::memory_order_release);
+					}
+					request->surface_.reset();
+					if (uploaded >= bytes || clock::now() - start >= time)
+						break;
+				}
+				return done;
+			}
+
+			/**
+			 * \brief the number of requests not completed by upload() yet
+			 */
+			size_t pending() const noexcept {
+				return pending_.load();
+			}
+		};
+
+		using AsyncLoaderPtr = std::shared_ptr<AsyncLoader>;
+
+		template <typename... Types>
+		AsyncLoaderPtr make_async_loader(Types &&... args) {
+			return std::make_shared<AsyncLoader>(std::forward<Types>(args)...);
+		}
+	}
+
+	namespace pointer {
+		using image::TextureRequestPtr;
+		using image::AsyncLoaderPtr;
+		using image::make_async_loader;
+	}
+}
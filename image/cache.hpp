@@ -0,0 +1,217 @@
+#pragma once
+
+#include "../sdl/sdl_packs.h"
+#include "image.hpp"
+#include <list>
+#include <string>
+#include <optional>
+#include <unordered_map>
+
+namespace leap {
+	namespace image {
+		/**
+		 * \brief conversions applied to an image after decoding, which are part of its cache key
+		 */
+		struct LoadOptions {
+			// the pixel format to convert to, SDL_PIXELFORMAT_UNKNOWN keeps the decoded format
+			Uint32 format = SDL_PIXELFORMAT_UNKNOWN;
+			std::optional<SDL_Color> color_key;
+			// only used for textures
+			SDL_BlendMode blend = SDL_BLENDMODE_BLEND;
+		};
+
+		struct CacheStats {
+			size_t hits, misses, evictions;
+			size_t bytes, entries;
+		};
+
+		/**
+		 * \brief applies \c options to a decoded surface
+		 */
+		inline pointer::SurfacePtr convert(const pointer::SurfacePtr &surface, const LoadOptions &options) {
+			pointer::SurfacePtr result = surface;
+			if (options.format != SDL_PIXELFORMAT_UNKNOWN && options.format != surface->get()->format->format) {
+				SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface->get(), options.format, 0);
+				if (converted == nullptr)
+					except::throw_exc();
+				result = pointer::make_surface(converted);
+			}
+			if (options.color_key)
+				result->set_color_key(*options.color_key);
+			return result;
+		}
+
+		/**
+		 * \brief Shares decoded images, keyed by path and LoadOptions, within a memory budget.
+		 * \details Least recently used entries are evicted once the budget is exceeded, but only those
+		 * no one else holds, so the usage may stay above the budget while every image is in use.
+		 * Surfaces and textures of the same path are cached separately.
+		 */
+		class AssetCache {
+			struct Entry {
+				std::string key;
+				pointer::SurfacePtr surface;
+				pointer::TexturePtr texture;
+				size_t bytes;
+
+				bool in_use() const noexcept {
+					return surface ? surface.use_count() > 1 : texture.use_count() > 1;
+				}
+			};
+
+			const render::Renderer *renderer_;
+			size_t budget_;
+			// the front is the most recently used entry
+			std::list<Entry> entries_;
+			std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+			CacheStats stats_{};
+
+			static std::string make_key(char kind, const std::string &path, const LoadOptions &options) {
+				std::string key(1, kind);
+				key += std::to_string(options.format);
+				if (options.color_key) {
+					const SDL_Color &c = *options.color_key;
+					key += ':' + std::to_string((c.r << 16) | (c.g << 8) | c.b);
+				}
+				if (kind == 't')
+					key += ':' + std::to_string(options.blend);
+				key += '|';
+				return key + path;
+			}
+
+			static size_t texture_bytes(SDL_Texture *texture) {
+				Uint32 format;
+				int w, h;
+				if (SDL_QueryTexture(texture, &format, nullptr, &w, &h))
+					except::throw_exc();
+				return static_cast<size_t>(w) * h * SDL_BYTESPERPIXEL(format);
+			}
+
+			Entry *find(const std::string &key) {
+				const auto it = index_.find(key);
+				if (it == index_.end()) {
+					++stats_.misses;
+					return nullptr;
+				}
+				++stats_.hits;
+				entries_.splice(entries_.begin(), entries_, it->second);
+				return &*it->second;
+			}
+
+			void insert(Entry entry) {
+				stats_.bytes += entry.bytes;
+				entries_.push_front(std::move(entry));
+				index_.emplace(entries_.front().key, entries_.begin());
+				trim();
+			}
+
+			void erase(std::list<Entry>::iterator it) {
+				stats_.bytes -= it->bytes;
+				index_.erase(it->key);
+				entries_.erase(it);
+			}
+
+		public:
+			/**
+			 * \param budget the number of bytes of pixels the cache aims to stay within
+			 */
+			explicit AssetCache(size_t budget = 256 << 20) noexcept : renderer_(nullptr), budget_(budget) {}
+
+			/**
+			 * \param renderer the renderer textures are created with, which must outlive the cache
+			 * \param budget the number of bytes of pixels the cache aims to stay within
+			 */
+			explicit AssetCache(const render::Renderer &renderer, size_t budget = 256 << 20) noexcept :
+				renderer_(&renderer), budget_(budget) {}
+
+			AssetCache(const AssetCache &) = delete;
+
+			/**
+			 * \brief loads an image as a surface, or returns the one loaded before with the same options
+			 */
+			pointer::SurfacePtr surface(const std::string &path, const LoadOptions &options = {}) {
+				std::string key = make_key('s', path, options);
+				if (Entry *entry = find(key))
+					return entry->surface;
+				auto result = convert(load(path), options);
+				const size_t bytes = static_cast<size_t>(result->get()->pitch) * result->get()->h;
+				insert(Entry{std::move(key), result, nullptr, bytes});
+				return result;
+			}
+
+			/**
+			 * \brief loads an image as a texture, or returns the one loaded before with the same options
+			 * \details the surface decoded is reused when it is cached, and is not cached otherwise
+			 */
+			pointer::TexturePtr texture(const std::string &path, const LoadOptions &options = {}) {
+				if (renderer_ == nullptr)
+					throw except::LeapException("the asset cache has no renderer");
+				std::string key = make_key('t', path, options);
+				if (Entry *entry = find(key))
+					return entry->texture;
+				const auto cached = index_.find(make_key('s', path, options));
+				const auto source = cached != index_.end() ? cached->second->surface : convert(load(path), options);
+				auto result = image::convert(*renderer_, source);
+				result->set_blend_mode(options.blend);
+				insert(Entry{std::move(key), nullptr, result, texture_bytes(result->get())});
+				return result;
+			}
+
+			/**
+			 * \brief evicts unused entries, least recently used first, until the usage is within the budget
+			 */
+			void trim() {
+				for (auto it = entries_.end(); stats_.bytes > budget_ && it != entries_.begin();) {
+					--it;
+					if (!it->in_use()) {
+						erase(it++);
+						++stats_.evictions;
+					}
+				}
+			}
+
+			/**
+			 * \brief drops every entry no one else holds, regardless of the budget
+			 */
+			void purge() {
+				for (auto it = entries_.begin(); it != entries_.end();) {
+					if (it->in_use())
+						++it;
+					else
+						erase(it++);
+				}
+			}
+
+			void set_budget(size_t budget) {
+				budget_ = budget;
+				trim();
+			}
+
+			size_t budget() const noexcept {
+				return budget_;
+			}
+
+			CacheStats stats() const noexcept {
+				CacheStats result = stats_;
+				result.entries = entries_.size();
+				return result;
+			}
+
+			void reset_stats() noexcept {
+				stats_.hits = stats_.misses = stats_.evictions = 0;
+			}
+		};
+
+		using AssetCachePtr = std::shared_ptr<AssetCache>;
+
+		template <typename... Types>
+		AssetCachePtr make_asset_cache(Types &&... args) {
+			return std::make_shared<AssetCache>(std::forward<Types>(args)...);
+		}
+	}
+
+	namespace pointer {
+		using image::AssetCachePtr;
+		using image::make_asset_cache;
+	}
+}
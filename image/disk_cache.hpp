@@ -0,0 +1,244 @@
+#pragma once
+
+#include "../sdl/sdl_packs.h"
+#include "image.hpp"
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+#include <system_error>
+
+namespace leap {
+	namespace image {
+		/**
+		 * \brief the 32-bit format with alpha the renderer prefers, which textures are uploaded in without conversion
+		 */
+		inline Uint32 native_format(const render::Renderer &renderer) noexcept {
+			SDL_RendererInfo info;
+			if (SDL_GetRendererInfo(renderer.get(), &info) == 0)
+				for (Uint32 i = 0; i < info.num_texture_formats; ++i) {
+					const Uint32 format = info.texture_formats[i];
+					if (SDL_BYTESPERPIXEL(format) == 4 && SDL_ISPIXELFORMAT_ALPHA(format))
+						return format;
+				}
+			return SDL_PIXELFORMAT_ARGB8888;
+		}
+
+		/**
+		 * \brief Keeps decoded images on disk in one pixel format, so later runs skip decoding.
+		 * \details Each source file has a cache file named by the hash of its path, which records the size and
+		 * modification time of the source. A cache file not matching its source is rebuilt on the next load.
+		 * Cache files are mapped and uploaded directly, so a hit costs about one copy of the pixels.
+		 */
+		class DiskCache {
+			struct Header {
+				char magic[8];
+				Uint32 version, format;
+				Sint64 mtime;
+				Uint64 source_size;
+				Uint32 w, h, pitch, reserved;
+			};
+
+			static_assert(sizeof(Header) == 48, "cache file header must not be padded");
+
+			static constexpr char magic[8] = {'L', 'E', 'A', 'P', 'P', 'I', 'X', '\0'};
+			static constexpr Uint32 version = 1;
+			// pixels start at a cache line
+			static constexpr size_t data_offset = 64;
+
+			std::filesystem::path directory_;
+			Uint32 format_;
+			size_t hits_ = 0, misses_ = 0;
+
+			static Uint64 hash(const std::string &text) noexcept {
+				Uint64 result = 14695981039346656037ull;
+				for (const char c : text)
+					result = (result ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+				return result;
+			}
+
+			std::filesystem::path entry_path(const std::string &path) const {
+				char name[24];
+				std::snprintf(name, sizeof(name), "%016llx.pix", static_cast<unsigned long long>(hash(path)));
+				return directory_ / name;
+			}
+
+			/**
+			 * \brief fills the header fields describing the source, returns false if the source cannot be examined
+			 */
+			static bool describe(const std::string &path, Header &header) noexcept {
+				std::error_code error;
+				const auto time = std::filesystem::last_write_time(path, error);
+				if (error)
+					return false;
+				const auto size = std::filesystem::file_size(path, error);
+				if (error)
+					return false;
+				header.mtime = static_cast<Sint64>(time.time_since_epoch().count());
+				header.source_size = size;
+				return true;
+			}
+
+			/**
+			 * \brief maps the cache file of \c path if it is up to date and whole, and leaves \c file empty otherwise,
+			 * so that the cache file can be replaced
+			 */
+			bool open(const std::string &path, mapped::MappedFile &file, Header &header) const {
+				Header source{};
+				if (!describe(path, source))
+					return false;
+				try {
+					file = mapped::MappedFile(entry_path(path).string());
+				}
+				catch (except::LeapException &) {
+					return false;
+				}
+				if (file.size() >= data_offset) {
+					std::memcpy(&header, file.data(), sizeof(Header));
+					const Uint64 row = static_cast<Uint64>(header.w) * SDL_BYTESPERPIXEL(format_);
+					// the last row may end right after its pixels
+					const Uint64 needed = header.h == 0 ? 0 : static_cast<Uint64>(header.h - 1) * header.pitch + row;
+					if (std::memcmp(header.magic, magic, sizeof(magic)) == 0 && header.version == version &&
+					    header.format == format_ && header.mtime == source.mtime &&
+					    header.source_size == source.source_size && header.pitch >= row &&
+					    file.size() - data_offset >= needed)
+						return true;
+				}
+				// a mapped view keeps Windows from replacing the file
+				file = mapped::MappedFile();
+				return false;
+			}
+
+			/**
+			 * \brief decodes the source, converts it and writes its cache file, failing to write is not an error
+			 */
+			pointer::SurfacePtr rebuild(const std::string &path) {
+				++misses_;
+				auto decoded = load(path);
+				SDL_Surface *converted = SDL_ConvertSurfaceFormat(decoded->get(), format_, 0);
+				if (converted == nullptr)
+					except::throw_exc();
+				auto surface = pointer::make_surface(converted);
+
+				Header header{};
+				if (!describe(path, header))
+					return surface;
+				std::memcpy(header.magic, magic, sizeof(magic));
+				header.version = version;
+				header.format = format_;
+				header.w = static_cast<Uint32>(converted->w);
+				header.h = static_cast<Uint32>(converted->h);
+				header.pitch = static_cast<Uint32>(converted->pitch);
+
+				std::error_code error;
+				std::filesystem::create_directories(directory_, error);
+				const auto target = entry_path(path);
+				auto temporary = target;
+				temporary += ".tmp";
+				{
+					std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+					static constexpr char padding[data_offset - sizeof(Header)] = {};
+					file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+					file.write(padding, sizeof(padding));
+					file.write(static_cast<const char *>(converted->pixels),
+					           static_cast<std::streamsize>(converted->pitch) * converted->h);
+					if (!file.flush())
+						return surface;
+				}
+				// renaming last, so that a cache file is never seen half written
+				std::filesystem::rename(temporary, target, error);
+				if (error)
+					std::filesystem::remove(temporary, error);
+				return surface;
+			}
+
+		public:
+			/**
+			 * \param directory the directory of the cache files, created when needed
+			 * \param format the pixel format images are stored and loaded in
+			 */
+			explicit DiskCache(std::filesystem::path directory, Uint32 format = SDL_PIXELFORMAT_ARGB8888) :
+				directory_(std::move(directory)), format_(format) {}
+
+			/**
+			 * \brief creates a cache storing images in the native format of \c renderer
+			 */
+			DiskCache(const render::Renderer &renderer, std::filesystem::path directory) :
+				DiskCache(std::move(directory), native_format(renderer)) {}
+
+			DiskCache(const DiskCache &) = delete;
+
+			/**
+			 * \brief loads an image as a texture of the format of the cache, decoding it only if its cache file is stale
+			 */
+			pointer::TexturePtr texture(const render::Renderer &renderer, const std::string &path) {
+				mapped::MappedFile file;
+				Header header;
+				if (!open(path, file, header)) {
+					auto texture = image::convert(renderer, rebuild(path));
+					texture->set_blend_mode(SDL_BLENDMODE_BLEND);
+					return texture;
+				}
+				++hits_;
+				auto texture = pointer::make_texture(renderer.create_texture(
+					format_, SDL_TEXTUREACCESS_STATIC, static_cast<int>(header.w), static_cast<int>(header.h)));
+				if (SDL_UpdateTexture(texture->get(), nullptr, file.data() + data_offset, static_cast<int>(header.pitch)))
+					except::throw_exc();
+				texture->set_blend_mode(SDL_BLENDMODE_BLEND);
+				return texture;
+			}
+
+			/**
+			 * \brief loads an image as a surface of the format of the cache, decoding it only if its cache file is stale
+			 */
+			pointer::SurfacePtr surface(const std::string &path) {
+				mapped::MappedFile file;
+				Header header;
+				if (!open(path, file, header))
+					return rebuild(path);
+				++hits_;
+				SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(
+					0, static_cast<int>(header.w), static_cast<int>(header.h), 32, format_);
+				if (surface == nullptr)
+					except::throw_exc();
+				const size_t row = static_cast<size_t>(header.w) * SDL_BYTESPERPIXEL(format_);
+				for (Uint32 y = 0; y < header.h; ++y)
+					std::memcpy(static_cast<std::byte *>(surface->pixels) + static_cast<size_t>(y) * surface->pitch,
+					            file.data() + data_offset + static_cast<size_t>(y) * header.pitch, row);
+				return pointer::make_surface(surface);
+			}
+
+			Uint32 format() const noexcept {
+				return format_;
+			}
+
+			/**
+			 * \brief the number of loads served from a cache file
+			 */
+			size_t hits() const noexcept {
+				return hits_;
+			}
+
+			/**
+			 * \brief the number of loads that decoded the source
+			 */
+			size_t misses() const noexcept {
+				return misses_;
+			}
+		};
+
+		using DiskCachePtr = std::shared_ptr<DiskCache>;
+
+		template <typename... Types>
+		DiskCachePtr make_disk_cache(Types &&... args) {
+			return std::make_shared<DiskCache>(std::forward<Types>(args)...);
+		}
+	}
+
+	namespace pointer {
+		using image::DiskCachePtr;
+		using image::make_disk_cache;
+	}
+}
@@ -2,6 +2,7 @@
 
 #include "../sdl/sdl_packs.h"
 #include "SDL_image.h"
+#include "qoi.hpp"
 
 namespace leap {
 	namespace image {
@@ -9,12 +10,28 @@ namespace leap {
 			if (IMG_Init(flag) != flag)
 				except::throw_exc();
 		}
+		/**
+		 * \brief decodes an image, QOI files, told by their extension, are decoded without SDL_image
+		 */
 		inline pointer::SurfacePtr load(const std::string &path) {
+			if (is_qoi(path))
+				return load_qoi(path);
 			auto surface = IMG_Load(path.c_str());
 			if (surface)
 				return pointer::make_surface(surface);
 			except::throw_exc();
 		}
+		/**
+		 * \brief decodes an image stored in an asset pack, without copying it out of the pack
+		 */
+		inline pointer::SurfacePtr load(const pack::Pack &pack, std::string_view name) {
+			if (is_qoi(name))
+				return decode_qoi(pack.at(name));
+			auto surface = IMG_Load_RW(pack.open(name), 1);
+			if (surface)
+				return pointer::make_surface(surface);
+			except::throw_exc();
+		}
 		inline pointer::TexturePtr convert(const render::Renderer &renderer, const surface::Surface &surface) {
 			return pointer::make_texture(renderer.convert(surface));
 		}
@@ -2,4 +2,8 @@
 
 // Note that this is a alias to image.hpp
 
-#include "image.hpp"
\ No newline at end of file
+#include "image.hpp"
+#include "qoi.hpp"
+#include "cache.hpp"
+#include "async.hpp"
+#include "disk_cache.hpp"
\ No newline at end of file
@@ -0,0 +1,242 @@
+#pragma once
+
+#include "../sdl/sdl_packs.h"
+#include <span>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <fstream>
+
+namespace leap {
+	namespace image {
+		/*
+		 * The QOI format, https://qoiformat.org: a 14 byte header, a stream of chunks each encoding one or more
+		 * pixels relative to the previous pixel or a table of recent pixels, and an 8 byte end marker.
+		 * Decoded surfaces are always SDL_PIXELFORMAT_RGBA32, which is the byte order of the format.
+		 */
+		namespace qoi {
+			constexpr Uint8 op_index = 0x00, op_diff = 0x40, op_luma = 0x80, op_run = 0xc0;
+			constexpr Uint8 op_rgb = 0xfe, op_rgba = 0xff, mask = 0xc0;
+			constexpr size_t header_size = 14;
+			constexpr Uint8 end_marker[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+			// the same limit as the reference implementation, which keeps every size within 32 bits
+			constexpr Uint32 max_pixels = 400000000;
+
+			struct Pixel {
+				Uint8 r, g, b, a;
+
+				bool operator==(const Pixel &other) const noexcept {
+					return r == other.r && g == other.g && b == other.b && a == other.a;
+				}
+			};
+
+			inline size_t hash(const Pixel &p) noexcept {
+				return (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) % 64;
+			}
+
+			inline Uint32 read_be(const Uint8 *bytes) noexcept {
+				return static_cast<Uint32>(bytes[0]) << 24 | static_cast<Uint32>(bytes[1]) << 16 |
+				       static_cast<Uint32>(bytes[2]) << 8 | bytes[3];
+			}
+
+			inline void write_be(std::vector<std::byte> &out, Uint32 value) {
+				for (int shift = 24; shift >= 0; shift -= 8)
+					out.push_back(static_cast<std::byte>(value >> shift));
+			}
+		}
+
+		/**
+		 * \brief decodes a QOI image
+		 * \param data the whole QOI file
+		 * \return the image, in SDL_PIXELFORMAT_RGBA32
+		 * \throw LeapException if the data is not a valid QOI image
+		 */
+		inline pointer::SurfacePtr decode_qoi(std::span<const std::byte> data) {
+			using namespace qoi;
+			const auto *bytes = reinterpret_cast<const Uint8 *>(data.data());
+			const size_t size = data.size();
+			if (size < header_size + sizeof(end_marker) || std::memcmp(bytes, "qoif", 4) != 0)
+				throw except::LeapException("not a QOI image");
+			const Uint32 w = read_be(bytes + 4), h = read_be(bytes + 8);
+			const Uint8 channels = bytes[12];
+			if (w == 0 || h == 0 || h >= max_pixels / w || (channels != 3 && channels != 4))
+				throw except::LeapException("invalid QOI header");
+
+			SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, static_cast<int>(w), static_cast<int>(h), 32,
+			                                                      SDL_PIXELFORMAT_RGBA32);
+			if (surface == nullptr)
+				except::throw_exc();
+			auto result = pointer::make_surface(surface);
+
+			Pixel index[64] = {};
+			Pixel px{0, 0, 0, 255};
+			size_t p = header_size, run = 0;
+			const size_t end = size - sizeof(end_marker);
+			for (Uint32 y = 0; y < h; ++y) {
+				auto *row = reinterpret_cast<Pixel *>(static_cast<Uint8 *>(surface->pixels) + static_cast<size_t>(y) * surface->pitch);
+				for (Uint32 x = 0; x < w; ++x) {
+					if (run > 0)
+						--run;
+					else {
+						if (p >= end)
+							throw except::LeapException("truncated QOI image");
+						const Uint8 b1 = bytes[p++];
+						if (b1 == op_rgb) {
+							if (p + 3 > end)
+								throw except::LeapException("truncated QOI image");
+							px.r = bytes[p];
+							px.g = bytes[p + 1];
+							px.b = bytes[p + 2];
+							p += 3;
+						}
+						else if (b1 == op_rgba) {
+							if (p + 4 > end)
+								throw except::LeapException("truncated QOI image");
+							px = {bytes[p], bytes[p + 1], bytes[p + 2], bytes[p + 3]};
+							p += 4;
+						}
+						else if ((b1 & mask) == op_index)
+							px = index[b1];
+						else if ((b1 & mask) == op_diff) {
+							px.r += ((b1 >> 4) & 0x03) - 2;
+							px.g += ((b1 >> 2) & 0x03) - 2;
+							px.b += (b1 & 0x03) - 2;
+						}
+						else if ((b1 & mask) == op_luma) {
+							if (p + 1 > end)
+								throw except::LeapException("truncated QOI image");
+							const Uint8 b2 = bytes[p++];
+							const int vg = (b1 & 0x3f) - 32;
+							px.r += vg - 8 + ((b2 >> 4) & 0x0f);
+							px.g += vg;
+							px.b += vg - 8 + (b2 & 0x0f);
+						}
+						else
+							run = b1 & 0x3f;
+						index[hash(px)] = px;
+					}
+					row[x] = px;
+				}
+			}
+			return result;
+		}
+
+		/**
+		 * \brief encodes a surface as a QOI image
+		 * \details a surface without alpha is stored with 3 channels, anything else with 4
+		 * \return the whole QOI file
+		 */
+		inline std::vector<std::byte> encode_qoi(const surface::Surface &image) {
+			using namespace qoi;
+			SDL_Surface *source = image.get();
+			SDL_Surface *converted = source;
+			if (source->format->format != SDL_PIXELFORMAT_RGBA32 || SDL_MUSTLOCK(source)) {
+				converted = SDL_ConvertSurfaceFormat(source, SDL_PIXELFORMAT_RGBA32, 0);
+				if (converted == nullptr)
+					except::throw_exc();
+			}
+			const pointer::SurfacePtr owner = converted != source ? pointer::make_surface(converted) : nullptr;
+			const Uint8 channels = SDL_ISPIXELFORMAT_ALPHA(source->format->format) ? 4 : 3;
+			const auto w = static_cast<Uint32>(converted->w), h = static_cast<Uint32>(converted->h);
+
+			std::vector<std::byte> out;
+			out.reserve(header_size + static_cast<size_t>(w) * h * (channels + 1) / 2 + sizeof(end_marker));
+			for (const char c : {'q', 'o', 'i', 'f'})
+				out.push_back(static_cast<std::byte>(c));
+			write_be(out, w);
+			write_be(out, h);
+			out.push_back(static_cast<std::byte>(channels));
+			out.push_back(std::byte{0});
+
+			const auto put = [&out](int value) {
+				out.push_back(static_cast<std::byte>(value));
+			};
+			Pixel index[64] = {};
+			Pixel previous{0, 0, 0, 255};
+			int run = 0;
+			for (Uint32 y = 0; y < h; ++y) {
+				const auto *row = reinterpret_cast<const Pixel *>(
+					static_cast<const Uint8 *>(converted->pixels) + static_cast<size_t>(y) * converted->pitch);
+				for (Uint32 x = 0; x < w; ++x) {
+					Pixel px = row[x];
+					if (channels == 3)
+						px.a = previous.a;
+					if (px == previous) {
+						if (++run == 62) {
+							put(op_run | (run - 1));
+							run = 0;
+						}
+						continue;
+					}
+					if (run > 0) {
+						put(op_run | (run - 1));
+						run = 0;
+					}
+					const size_t slot = hash(px);
+					if (index[slot] == px)
+						put(op_index | static_cast<int>(slot));
+					else {
+						index[slot] = px;
+						if (px.a == previous.a) {
+							const auto vr = static_cast<Sint8>(px.r - previous.r);
+							const auto vg = static_cast<Sint8>(px.g - previous.g);
+							const auto vb = static_cast<Sint8>(px.b - previous.b);
+							const int vg_r = vr - vg, vg_b = vb - vg;
+							if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2)
+								put(op_diff | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2));
+							else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8) {
+								put(op_luma | (vg + 32));
+								put((vg_r + 8) << 4 | (vg_b + 8));
+							}
+							else {
+								put(op_rgb);
+								put(px.r);
+								put(px.g);
+								put(px.b);
+							}
+						}
+						else {
+							put(op_rgba);
+							put(px.r);
+							put(px.g);
+							put(px.b);
+							put(px.a);
+						}
+					}
+					previous = px;
+				}
+			}
+			if (run > 0)
+				put(op_run | (run - 1));
+			for (const Uint8 b : end_marker)
+				put(b);
+			return out;
+		}
+
+		/**
+		 * \brief reads a QOI file
+		 */
+		inline pointer::SurfacePtr load_qoi(const std::string &path) {
+			const mapped::MappedFile file(path);
+			return decode_qoi(file.bytes());
+		}
+
+		/**
+		 * \brief writes a surface into a QOI file
+		 */
+		inline void save_qoi(const surface::Surface &image, const std::string &path) {
+			const auto data = encode_qoi(image);
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+			if (!file.flush())
+				throw except::LeapException("cannot write " + path);
+		}
+
+		inline bool is_qoi(std::string_view path) noexcept {
+			if (path.size() < 4)
+				return false;
+			const auto ext = path.substr(path.size() - 4);
+			return ext == ".qoi" || ext == ".QOI";
+		}
+	}
+}
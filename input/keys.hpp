@@ -16,6 +16,9 @@ namespace leap {
 			class KeyMap {
 				KeySet key_down_;
 				Keycode key_pressed_ = SDLK_UNKNOWN;
+				// the keys pressed and released since end_frame, and the last key pressed
+				KeySet pressed_, released_;
+				Keycode latched_ = SDLK_UNKNOWN;
 
 			public:
 				KeyMap() = default;
@@ -30,25 +33,50 @@ namespace leap {
 				}
 
 				void key_down(const Keycode &key) noexcept {
-					key_pressed_ = key;
+					key_pressed_ = latched_ = key;
 					key_down_.insert(key);
+					pressed_.insert(key);
 				}
 
 				void key_up(const Keycode &key) noexcept {
 					key_pressed_ = SDLK_UNKNOWN;
 					key_down_.erase(key);
+					released_.insert(key);
 				}
 
+				/**
+				 * \brief whether \c key is held, or was pressed since the last end_frame
+				 */
 				bool is_down(const Keycode &key) const noexcept {
-					return key_down_.contains(key);
+					return key_down_.contains(key) || pressed_.contains(key);
 				}
 
 				bool is_up(const Keycode &key) const noexcept {
 					return !is_down(key);
 				}
 
+				/**
+				 * \return the key held since the last key pressed, or else the last key pressed and released
+				 * since end_frame, or SDLK_UNKNOWN
+				 */
 				const Keycode &pressed() const noexcept {
-					return key_pressed_;
+					return key_pressed_ != SDLK_UNKNOWN ? key_pressed_ : latched_;
+				}
+
+				/**
+				 * \brief whether \c key was released since the last end_frame
+				 */
+				bool released(const Keycode &key) const noexcept {
+					return released_.contains(key);
+				}
+
+				/**
+				 * \brief forgets the presses and releases latched, to call once the widgets are updated
+				 */
+				void end_frame() noexcept {
+					pressed_.clear();
+					released_.clear();
+					latched_ = SDLK_UNKNOWN;
 				}
 			};
 
@@ -8,10 +8,22 @@ namespace leap {
 			using MouseButtonType = decltype(SDL_MouseButtonEvent().button);
 			constexpr MouseButtonType left = 1, middle = 2, right = 3, wheel_up = 4, wheel_down = 5;
 
+			/**
+			 * \brief The state of the mouse, fed with its events.
+			 * \details The presses and releases of a frame are latched until end_frame, so a button pressed and
+			 * released between two updates still reads as pressed for one frame.
+			 */
 			class Mouse {
-				SDL_MouseButtonEvent button_;
-				SDL_MouseMotionEvent motion_;
-				SDL_MouseWheelEvent wheel_;
+				SDL_MouseMotionEvent motion_{};
+				SDL_MouseWheelEvent wheel_{};
+				// SDL_BUTTON masks of the buttons held, and of the ones pressed and released since end_frame
+				Uint32 down_ = 0, pressed_ = 0, released_ = 0;
+
+				static Uint32 mask_of(MouseButtonType button) {
+					if (button < left || button > right)
+						throw except::LeapException("Invalid mouse button " + std::to_string(button));
+					return SDL_BUTTON(button);
+				}
 
 			public:
 				Mouse() = default;
@@ -19,7 +31,18 @@ namespace leap {
 				~Mouse() = default;
 
 				void button(const SDL_MouseButtonEvent &button) noexcept {
-					button_ = button;
+					const Uint32 mask = SDL_BUTTON(button.button);
+					if (button.type == SDL_MOUSEBUTTONDOWN) {
+						down_ |= mask;
+						pressed_ |= mask;
+					}
+					else {
+						down_ &= ~mask;
+						released_ |= mask;
+					}
+					// a tap may come without any motion before it
+					motion_.x = button.x;
+					motion_.y = button.y;
 				}
 
 				void motion(const SDL_MouseMotionEvent &motion) noexcept {
@@ -30,28 +53,32 @@ namespace leap {
 					wheel_ = wheel;
 				}
 
+				/**
+				 * \brief whether \c button is held, or was pressed since the last end_frame
+				 */
 				bool pressed(MouseButtonType button) const {
 					switch (button) {
-					case 1:
-						if (button_.type == SDL_MOUSEBUTTONDOWN)
-							return button_.button == SDL_BUTTON_LEFT;
-						break;
-					case 2:
-						if (button_.type == SDL_MOUSEBUTTONDOWN)
-							return button_.button == SDL_BUTTON_MIDDLE;
-						break;
-					case 3:
-						if (button_.type == SDL_MOUSEBUTTONDOWN)
-							return button_.button == SDL_BUTTON_RIGHT;
-						break;
-					case 4:
+					case wheel_up:
 						return wheel_.y > 0;
-					case 5:
+					case wheel_down:
 						return wheel_.y < 0;
 					default:
-						throw except::LeapException("Invalid mouse button " + std::to_string(button));
+						return ((down_ | pressed_) & mask_of(button)) != 0;
 					}
-					return false;
+				}
+
+				/**
+				 * \brief whether \c button was released since the last end_frame
+				 */
+				bool released(MouseButtonType button) const {
+					return (released_ & mask_of(button)) != 0;
+				}
+
+				/**
+				 * \brief forgets the presses and releases latched, to call once the widgets are updated
+				 */
+				void end_frame() noexcept {
+					pressed_ = released_ = 0;
 				}
 
 				pos::IPoint get_position() const noexcept {
@@ -1,38 +1,23 @@
 #pragma once
 
-#include "../sdl/sdl_packs.hpp"
+#include "../sdl/sdl_packs.h"
 #include "SDL_mixer.h"
 #include <memory>
 
 namespace leap {
 	namespace mixer {
-		void pause(int channel = -1) {
+		inline void pause(int channel = -1) {
 			Mix_Pause(channel);
 		}
 
-		void halt(int channel=-1) {
-			if (Mix_HaltChannel(-1)) {
-				except::throw_exc();
-			}
-		}
-
-		void fade_out(int channel, int ms) {
-			if (Mix_FadeOutChannel(channel)) {
-				except::throw_exc();
-			}
+		inline void halt(int channel=-1) {
+			Mix_HaltChannel(channel);
 		}
 
-		void fade_in(int channel, int ms) {
-			if (Mix_FadeInChannel(channel, ms)) {
-				except::throw_exc();
-			}
+		inline void fade_out(int channel, int ms) {
+			Mix_FadeOutChannel(channel, ms);
 		}
 
-		void fade_in_timed(int channel, int ms, int ticks) {
-			if (Mix_FadeInChannel(channel, ms, ticks)) {
-				except::throw_exc();
-			}
-		}
 		class Chunk {
 			Mix_Chunk* chunk_;
 		public:
@@ -42,18 +27,46 @@ namespace leap {
 				}
 			}
 
+			/**
+			 * \param rw the stream to decode the sound from, which is closed by the chunk
+			 */
+			explicit Chunk(SDL_RWops *rw) : chunk_(Mix_LoadWAV_RW(rw, 1)) {
+				if (chunk_ == nullptr) {
+					except::throw_exc();
+				}
+			}
+
+			/**
+			 * \brief decodes a sound stored in an asset pack, the pack is only read while constructing
+			 */
+			Chunk(const pack::Pack &pack, std::string_view name) : Chunk(pack.open(name)) {}
+
 			~Chunk() {
 				Mix_FreeChunk(chunk_);
 			}
 
+			Chunk(const Chunk &) = delete;
+
 			void play(int loops=1, int channel=-1) {
-				if (Mix_PlayChannel(channel, chunk_, loops)) {
+				if (Mix_PlayChannel(channel, chunk_, loops) == -1) {
 					except::throw_exc();
 				}
 			}
 
 			void play_timed(int loops=1, int ms=-1, int channel=-1) {
-				if (Mix_PlayChannelTimed(channel, chunk_, loops, ms)) {
+				if (Mix_PlayChannelTimed(channel, chunk_, loops, ms) == -1) {
+					except::throw_exc();
+				}
+			}
+
+			void fade_in(int ms, int loops=1, int channel=-1) {
+				if (Mix_FadeInChannel(channel, chunk_, loops, ms) == -1) {
+					except::throw_exc();
+				}
+			}
+
+			void fade_in_timed(int ms, int ticks, int loops=1, int channel=-1) {
+				if (Mix_FadeInChannelTimed(channel, chunk_, loops, ms, ticks) == -1) {
 					except::throw_exc();
 				}
 			}
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "const.h"
+#include "except.hpp"
+#include "position.hpp"
+#include "render.hpp"
+#include "texture.hpp"
+#include "surface.hpp"
+#include "pointer.hpp"
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+namespace leap {
+	namespace atlas {
+		/**
+		 * \brief A skyline rectangle packer, which places each rectangle as low as possible.
+		 */
+		class Skyline {
+			struct Segment {
+				int x, y, w;
+			};
+
+			pos::IPoint size_;
+			std::vector<Segment> skyline_;
+			long long used_ = 0;
+
+			/**
+			 * \return the lowest y a rectangle starting at segment \c index fits at, or -1 if it does not fit
+			 */
+			int fit(size_t index, int w, int h) const noexcept {
+				if (skyline_[index].x + w > size_.x)
+					return -1;
+				int y = 0;
+				for (size_t i = index; w > 0; ++i) {
+					y = std::max(y, skyline_[i].y);
+					if (y + h > size_.y)
+						return -1;
+					w -= skyline_[i].w;
+				}
+				return y;
+			}
+
+			void place(size_t index, const pos::IRect &rect) {
+				skyline_.insert(skyline_.begin() + static_cast<long>(index), Segment{rect.x, rect.y + rect.h, rect.w});
+				for (size_t i = index + 1; i < skyline_.size();) {
+					const Segment &previous = skyline_[i - 1];
+					Segment &segment = skyline_[i];
+					const int overlap = previous.x + previous.w - segment.x;
+					if (overlap <= 0)
+						break;
+					segment.x += overlap;
+					segment.w -= overlap;
+					if (segment.w <= 0)
+						skyline_.erase(skyline_.begin() + static_cast<long>(i));
+					else
+						break;
+				}
+				for (size_t i = 1; i < skyline_.size();) {
+					if (skyline_[i - 1].y == skyline_[i].y) {
+						skyline_[i - 1].w += skyline_[i].w;
+						skyline_.erase(skyline_.begin() + static_cast<long>(i));
+					}
+					else
+						++i;
+				}
+			}
+
+		public:
+			explicit Skyline(const pos::IPoint &size) : size_(size) {
+				skyline_.push_back(Segment{0, 0, size.x});
+			}
+
+			/**
+			 * \brief finds a place for a rectangle
+			 * \param size the size of the rectangle
+			 * \param result where the rectangle is placed
+			 * \return whether there is room for the rectangle
+			 */
+			bool insert(const pos::IPoint &size, pos::IRect &result) {
+				int best_y = std::numeric_limits<int>::max(), best_w = std::numeric_limits<int>::max();
+				size_t best = skyline_.size();
+				for (size_t i = 0; i < skyline_.size(); ++i) {
+					const int y = fit(i, size.x, size.y);
+					if (y >= 0 && (y + size.y < best_y || (y + size.y == best_y && skyline_[i].w < best_w))) {
+						best = i;
+						best_y = y + size.y;
+						best_w = skyline_[i].w;
+					}
+				}
+				if (best == skyline_.size())
+					return false;
+				result = {skyline_[best].x, best_y - size.y, size.x, size.y};
+				place(best, result);
+				used_ += static_cast<long long>(size.x) * size.y;
+				return true;
+			}
+
+			/**
+			 * \brief enlarges the packing area, keeping every rectangle placed so far
+			 */
+			void grow(const pos::IPoint &size) {
+				if (size.x > size_.x)
+					skyline_.push_back(Segment{size_.x, 0, size.x - size_.x});
+				size_ = {std::max(size.x, size_.x), std::max(size.y, size_.y)};
+			}
+
+			const pos::IPoint &size() const noexcept {
+				return size_;
+			}
+
+			/**
+			 * \brief the fraction of the area taken by rectangles
+			 */
+			double occupancy() const noexcept {
+				return static_cast<double>(used_) / (static_cast<double>(size_.x) * size_.y);
+			}
+		};
+
+		/**
+		 * \brief Packs many small images into a few large textures.
+		 * \details Images are returned as sub textures, which can be used wherever a TexturePtr is.
+		 * A full page is doubled in size on the GPU until the maximum size is reached, after which a new page
+		 * is opened. Space is never reclaimed, so the atlas suits images that live as long as it does.
+		 */
+		class Atlas {
+			struct Page {
+				pointer::TexturePtr texture;
+				Skyline packer;
+			};
+
+			static constexpr Uint32 format = SDL_PIXELFORMAT_ARGB8888;
+
+			const render::Renderer &renderer_;
+			std::vector<Page> pages_;
+			int initial_size_, max_size_, padding_;
+
+			SDL_Texture *create_page_texture(int size) const {
+				SDL_Texture *texture = renderer_.create_texture(format, SDL_TEXTUREACCESS_TARGET, size, size);
+				if (SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND)) {
+					SDL_DestroyTexture(texture);
+					except::throw_exc();
+				}
+				const render::TargetScope scope(renderer_, texture);
+				renderer_.set_color(0, 0, 0, 0);
+				renderer_.clear();
+				return texture;
+			}
+
+			void grow(Page &page) {
+				const int old_size = page.packer.size().x, size = std::min(old_size * 2, max_size_);
+				SDL_Texture *bigger = create_page_texture(size);
+				SDL_Texture *old = page.texture->get();
+				{
+					const render::TargetScope scope(renderer_, bigger);
+					const SDL_Rect dst{0, 0, old_size, old_size};
+					SDL_SetTextureBlendMode(old, SDL_BLENDMODE_NONE);
+					renderer_.copy(old, nullptr, &dst);
+				}
+				page.texture->reset(bigger);
+				page.packer.grow({size, size});
+			}
+
+			static void upload(const Page &page, const pos::IRect &rect, SDL_Surface *surface) {
+				SDL_Surface *converted = surface;
+				if (surface->format->format != format || SDL_MUSTLOCK(surface)) {
+					converted = SDL_ConvertSurfaceFormat(surface, format, 0);
+					if (converted == nullptr)
+						except::throw_exc();
+				}
+				const int failed = SDL_UpdateTexture(page.texture->get(), &rect, converted->pixels, converted->pitch);
+				if (converted != surface)
+					SDL_FreeSurface(converted);
+				if (failed)
+					except::throw_exc();
+			}
+
+		public:
+			/**
+			 * \param renderer the renderer owning the pages, which must outlive the atlas
+			 * \param initial_size the side of a new page in pixels
+			 * \param max_size the largest side a page can grow to, limited by the renderer
+			 * \param padding empty pixels kept between images, so that linear filtering does not bleed
+			 */
+			explicit Atlas(const render::Renderer &renderer, int initial_size = 512, int max_size = 4096,
+			               int padding = 1) :
+				renderer_(renderer), initial_size_(initial_size), max_size_(max_size), padding_(padding) {
+				SDL_RendererInfo info;
+				if (SDL_GetRendererInfo(renderer.get(), &info) == 0 && info.max_texture_width > 0)
+					max_size_ = std::min({max_size_, info.max_texture_width, info.max_texture_height});
+				initial_size_ = std::min(initial_size_, max_size_);
+			}
+
+			Atlas(const Atlas &) = delete;
+
+			/**
+			 * \brief copies an image into the atlas
+			 * \param surface the image
+			 * \return a sub texture showing the image
+			 */
+			pointer::TexturePtr add(SDL_Surface *surface) {
+				const pos::IPoint padded(surface->w + padding_, surface->h + padding_);
+				if (padded.x > max_size_ || padded.y > max_size_)
+					throw except::LeapException("image is larger than the atlas page");
+
+				pos::IRect rect;
+				Page *target = nullptr;
+				for (auto &page : pages_) {
+					bool placed = page.packer.insert(padded, rect);
+					while (!placed && page.packer.size().x < max_size_) {
+						grow(page);
+						placed = page.packer.insert(padded, rect);
+					}
+					if (placed) {
+						target = &page;
+						break;
+					}
+				}
+				if (target == nullptr) {
+					int size = initial_size_;
+					while (size < padded.x || size < padded.y)
+						size *= 2;
+					size = std::min(size, max_size_);
+					pages_.push_back(Page{pointer::make_texture(create_page_texture(size)), Skyline({size, size})});
+					target = &pages_.back();
+					target->packer.insert(padded, rect);
+				}
+
+				const pos::IRect region(rect.x, rect.y, surface->w, surface->h);
+				upload(*target, region, surface);
+				return pointer::make_texture(target->texture, region);
+			}
+
+			pointer::TexturePtr add(const surface::Surface &surface) {
+				return add(surface.get());
+			}
+
+			pointer::TexturePtr add(const pointer::SurfacePtr &surface) {
+				return add(surface->get());
+			}
+
+			size_t page_count() const noexcept {
+				return pages_.size();
+			}
+
+			const pointer::TexturePtr &page(size_t index) const {
+				return pages_.at(index).texture;
+			}
+
+			/**
+			 * \brief the fraction of page area taken by images of the page at \c index
+			 */
+			double occupancy(size_t index) const {
+				return pages_.at(index).packer.occupancy();
+			}
+		};
+
+		using AtlasPtr = std::shared_ptr<Atlas>;
+
+		template <typename... Types>
+		AtlasPtr make_atlas(Types &&... args) {
+			return std::make_shared<Atlas>(std::forward<Types>(args)...);
+		}
+	}
+
+	namespace pointer {
+		using atlas::AtlasPtr;
+		using atlas::make_atlas;
+	}
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include "const.h"
+#include "except.hpp"
+#include "position.hpp"
+#include "render.hpp"
+#include "texture.hpp"
+#include <vector>
+#include <numeric>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <numbers>
+
+namespace leap {
+	namespace batch {
+		/**
+		 * \brief per-sprite options of SpriteBatch::draw
+		 */
+		struct SpriteOptions {
+			SDL_Color tint{255, 255, 255, 255};
+			// rotation in degrees, clockwise, the same as SDL_RenderCopyEx
+			double angle = 0;
+			// rotation center relative to the destination, the center of the destination if empty
+			std::optional<pos::FPoint> center;
+			SDL_RendererFlip flip = SDL_FLIP_NONE;
+			SDL_BlendMode blend = SDL_BLENDMODE_BLEND;
+			// sprites of lower layers are always drawn first when sorting by texture
+			int layer = 0;
+		};
+
+		/**
+		 * \brief Accumulates textured quads and draws them with as few SDL_RenderGeometry calls as possible.
+		 * \details The batch stores raw texture handles, so every texture drawn must outlive the next flush.
+		 * Flushing sets the blend mode of each texture to the blend mode of its sprites.
+		 */
+		class SpriteBatch {
+		public:
+			enum class SortMode {
+				// keeps the submission order, and only merges consecutive sprites of the same texture
+				deferred,
+				// sorts by layer, blend mode and texture, so sprites of one layer must not rely on overlapping order
+				texture
+			};
+
+		private:
+			struct Key {
+				SDL_Texture *texture;
+				SDL_BlendMode blend;
+				int layer;
+
+				bool joins(const Key &other) const noexcept {
+					return texture == other.texture && blend == other.blend;
+				}
+			};
+
+			SortMode sort_;
+
+			std::vector<Key> keys_;
+			std::vector<SDL_Vertex> vertices_;
+
+			std::vector<size_t> order_;
+			std::vector<SDL_Vertex> sorted_;
+			std::vector<int> indices_;
+
+			SDL_Texture *last_texture_ = nullptr;
+			pos::FPoint last_size_;
+
+			size_t draw_calls_ = 0;
+
+			pos::FPoint texture_size(SDL_Texture *texture) {
+				if (texture != last_texture_) {
+					int w, h;
+					if (SDL_QueryTexture(texture, nullptr, nullptr, &w, &h))
+						except::throw_exc();
+					last_texture_ = texture;
+					last_size_ = {static_cast<float>(w), static_cast<float>(h)};
+				}
+				return last_size_;
+			}
+
+			void reserve_indices(size_t quads) {
+				for (size_t i = indices_.size() / 6; i < quads; ++i) {
+					const int base = static_cast<int>(i * 4);
+					indices_.insert(indices_.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+				}
+			}
+
+			void submit(const render::Renderer &renderer, const Key &key, const SDL_Vertex *vertices, size_t quads) {
+				if (SDL_SetTextureBlendMode(key.texture, key.blend))
+					except::throw_exc();
+				renderer.geometry(key.texture, vertices, static_cast<int>(quads * 4),
+				                  indices_.data(), static_cast<int>(quads * 6));
+				++draw_calls_;
+			}
+
+			void push(SDL_Texture *texture, const pos::FPoint &size, const pos::IRect &src, const pos::FRect &dst,
+			          const SpriteOptions &options) {
+				float u0 = static_cast<float>(src.x) / size.x, v0 = static_cast<float>(src.y) / size.y;
+				float u1 = static_cast<float>(src.x + src.w) / size.x, v1 = static_cast<float>(src.y + src.h) / size.y;
+				if (options.flip & SDL_FLIP_HORIZONTAL)
+					std::swap(u0, u1);
+				if (options.flip & SDL_FLIP_VERTICAL)
+					std::swap(v0, v1);
+
+				const pos::FPoint center = options.center.value_or(pos::FPoint(dst.w / 2, dst.h / 2));
+				const pos::FPoint origin(dst.x + center.x, dst.y + center.y);
+				pos::FPoint corners[4] = {
+					{-center.x, -center.y},
+					{dst.w - center.x, -center.y},
+					{dst.w - center.x, dst.h - center.y},
+					{-center.x, dst.h - center.y}
+				};
+
+				if (options.angle != 0) {
+					const double rad = options.angle * std::numbers::pi / 180;
+					const auto c = static_cast<float>(std::cos(rad)), s = static_cast<float>(std::sin(rad));
+					for (auto &corner : corners)
+						corner = {corner.x * c - corner.y * s, corner.x * s + corner.y * c};
+				}
+
+				const SDL_FPoint uvs[4] = {{u0, v0}, {u1, v0}, {u1, v1}, {u0, v1}};
+				for (int i = 0; i < 4; ++i)
+					vertices_.push_back(SDL_Vertex{corners[i] + origin, options.tint, uvs[i]});
+				keys_.push_back(Key{texture, options.blend, options.layer});
+			}
+
+		public:
+			explicit SpriteBatch(SortMode sort = SortMode::texture, size_t reserve = 1024) : sort_(sort) {
+				keys_.reserve(reserve);
+				vertices_.reserve(reserve * 4);
+				reserve_indices(reserve);
+			}
+
+			SpriteBatch(const SpriteBatch &) = delete;
+
+			/**
+			 * \brief queues a part of the texture to be drawn at the next flush
+			 * \param texture the texture to draw
+			 * \param src the part of the texture to draw, in pixels
+			 * \param dst where to draw the sprite, rotation is applied afterwards
+			 * \param options tint, rotation, flipping, blending and layer of the sprite
+			 */
+			void draw(const texture::Texture &texture, const pos::IRect &src, const pos::FRect &dst,
+			          const SpriteOptions &options = {}) {
+				push(texture.get(), texture_size(texture.get()), texture.to_source(src), dst, options);
+			}
+
+			void draw(const texture::Texture &texture, const pos::FRect &dst, const SpriteOptions &options = {}) {
+				push(texture.get(), texture_size(texture.get()), texture.source_range(), dst, options);
+			}
+
+			void draw(const texture::Texture &texture, const pos::FPoint &dst, const SpriteOptions &options = {}) {
+				const auto src = texture.source_range();
+				push(texture.get(), texture_size(texture.get()), src,
+				     {dst.x, dst.y, static_cast<float>(src.w), static_cast<float>(src.h)}, options);
+			}
+
+			/**
+			 * \brief draws every queued sprite and empties the batch
+			 * \param renderer the renderer to draw with
+			 */
+			void flush(const render::Renderer &renderer) {
+				draw_calls_ = 0;
+				const size_t count = keys_.size();
+				if (count == 0)
+					return;
+				reserve_indices(count);
+
+				if (sort_ == SortMode::deferred) {
+					size_t begin = 0;
+					for (size_t i = 1; i <= count; ++i) {
+						if (i == count || !keys_[i].joins(keys_[begin])) {
+							submit(renderer, keys_[begin], vertices_.data() + begin * 4, i - begin);
+							begin = i;
+						}
+					}
+				}
+				else {
+					order_.resize(count);
+					std::iota(order_.begin(), order_.end(), 0);
+					std::stable_sort(order_.begin(), order_.end(), [this](size_t lhs, size_t rhs) {
+						const Key &l = keys_[lhs], &r = keys_[rhs];
+						if (l.layer != r.layer)
+							return l.layer < r.layer;
+						if (l.blend != r.blend)
+							return l.blend < r.blend;
+						return std::less<SDL_Texture *>()(l.texture, r.texture);
+					});
+
+					sorted_.resize(count * 4);
+					for (size_t i = 0; i < count; ++i)
+						std::copy_n(vertices_.begin() + order_[i] * 4, 4, sorted_.begin() + i * 4);
+
+					size_t begin = 0;
+					for (size_t i = 1; i <= count; ++i) {
+						if (i == count || !keys_[order_[i]].joins(keys_[order_[begin]])) {
+							submit(renderer, keys_[order_[begin]], sorted_.data() + begin * 4, i - begin);
+							begin = i;
+						}
+					}
+				}
+				clear();
+			}
+
+			/**
+			 * \brief drops every queued sprite without drawing
+			 */
+			void clear() noexcept {
+				keys_.clear();
+				vertices_.clear();
+				last_texture_ = nullptr;
+			}
+
+			size_t size() const noexcept {
+				return keys_.size();
+			}
+
+			/**
+			 * \brief the number of SDL_RenderGeometry calls issued by the last flush
+			 */
+			size_t draw_calls() const noexcept {
+				return draw_calls_;
+			}
+
+			void set_sort_mode(SortMode sort) noexcept {
+				sort_ = sort;
+			}
+		};
+	}
+}
@@ -1,5 +1,8 @@
 #pragma once
 #include "const.h"
+#include "except.hpp"
+#include "kernel.hpp"
+#include <span>
 #include <limits>
 #include <algorithm>
 
@@ -56,6 +59,165 @@ namespace leap {
 					a
 				};
 			}
+
+			/**
+			 * \brief the color multiplied by its alpha, rounded to nearest
+			 */
+			[[nodiscard]] Color premultiplied() const noexcept {
+				return unpack(kernel::detail::premultiply(pack()));
+			}
+
+			/**
+			 * \brief the color of a premultiplied color divided by its alpha, 0 if it is fully transparent
+			 */
+			[[nodiscard]] Color unpremultiplied() const noexcept {
+				return unpack(kernel::detail::unpremultiply(pack(), kernel::detail::reciprocals()));
+			}
+
+			/**
+			 * \brief draws \c src over this color
+			 * \param mode how the colors mix, both colors must be premultiplied for Blend::premultiplied
+			 */
+			[[nodiscard]] Color blended(const Color &src, kernel::Blend mode = kernel::Blend::straight) const noexcept {
+				Uint32 pixel = pack();
+				const Uint32 source = src.pack();
+				kernel::blend(&pixel, &source, 1, mode);
+				return unpack(pixel);
+			}
+
+			/**
+			 * \brief the color as a pixel with alpha in the top byte, as the kernels take
+			 */
+			Uint32 pack() const noexcept {
+				return static_cast<Uint32>(a) << 24 | static_cast<Uint32>(r) << 16 | static_cast<Uint32>(g) << 8 | b;
+			}
+
+			static Color unpack(Uint32 pixel) noexcept {
+				return {static_cast<int_type>(pixel >> 16), static_cast<int_type>(pixel >> 8),
+				        static_cast<int_type>(pixel), static_cast<int_type>(pixel >> 24)};
+			}
 		};
+
+		/*
+		 * Batches of the Color methods over spans of colors, run by the SIMD kernels, with the same results.
+		 * A Color is laid out as r, g, b and a bytes, which little-endian kernels read with alpha in the top byte.
+		 */
+
+		static_assert(sizeof(Color) == 4, "the batches read colors as 32-bit pixels");
+
+		enum class Space {
+			// interpolates the sRGB values as they are
+			srgb,
+			// interpolates in linear light, as light mixes
+			linear
+		};
+
+		namespace detail {
+			inline void check_sizes(size_t lhs, size_t rhs) {
+				if (lhs != rhs)
+					throw except::LeapException("color spans of different sizes");
+			}
+
+			inline Uint32 *pixels(std::span<Color> colors) noexcept {
+				return reinterpret_cast<Uint32 *>(colors.data());
+			}
+
+			inline const Uint32 *pixels(std::span<const Color> colors) noexcept {
+				return reinterpret_cast<const Uint32 *>(colors.data());
+			}
+		}
+
+		/**
+		 * \brief writes \c lhs[i].merge_rgb(rhs[i]) into \c out[i], \c out may be either input
+		 */
+		inline void merge_rgb(std::span<const Color> lhs, std::span<const Color> rhs, std::span<Color> out) {
+			detail::check_sizes(lhs.size(), rhs.size());
+			detail::check_sizes(lhs.size(), out.size());
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+			kernel::merge_rgb(detail::pixels(out), detail::pixels(lhs), detail::pixels(rhs), out.size());
+#else
+			for (size_t i = 0; i < out.size(); ++i)
+				out[i] = lhs[i].merge_rgb(rhs[i]);
+#endif
+		}
+
+		/**
+		 * \brief writes \c lhs[i].merge(rhs[i]) into \c out[i], \c out may be either input
+		 */
+		inline void merge(std::span<const Color> lhs, std::span<const Color> rhs, std::span<Color> out) {
+			detail::check_sizes(lhs.size(), rhs.size());
+			detail::check_sizes(lhs.size(), out.size());
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+			kernel::merge(detail::pixels(out), detail::pixels(lhs), detail::pixels(rhs), out.size());
+#else
+			for (size_t i = 0; i < out.size(); ++i)
+				out[i] = lhs[i].merge(rhs[i]);
+#endif
+		}
+
+		/**
+		 * \brief replaces every color by color.dim(value)
+		 */
+		inline void dim(std::span<Color> colors, int value) noexcept {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+			kernel::dim(detail::pixels(colors), colors.size(), value, 0xff000000);
+#else
+			for (auto &color : colors)
+				color = color.dim(value);
+#endif
+		}
+
+		inline void premultiply(std::span<Color> colors) noexcept {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+			// r, g and b all take the same factor, so their order within the pixel does not matter
+			kernel::premultiply(detail::pixels(colors), colors.size());
+#else
+			for (auto &color : colors)
+				color = color.premultiplied();
+#endif
+		}
+
+		inline void unpremultiply(std::span<Color> colors) noexcept {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+			kernel::unpremultiply(detail::pixels(colors), colors.size());
+#else
+			for (auto &color : colors)
+				color = color.unpremultiplied();
+#endif
+		}
+
+		/**
+		 * \brief draws \c src[i] over \c dst[i], as Color::blended
+		 */
+		inline void blend(std::span<Color> dst, std::span<const Color> src, kernel::Blend mode = kernel::Blend::straight) {
+			detail::check_sizes(dst.size(), src.size());
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+			kernel::blend(detail::pixels(dst), detail::pixels(src), dst.size(), mode);
+#else
+			for (size_t i = 0; i < dst.size(); ++i)
+				dst[i] = dst[i].blended(src[i], mode);
+#endif
+		}
+
+		/**
+		 * \brief fills \c out with a gradient from \c from at the first color to \c to at the last
+		 * \param space where the color channels are interpolated, alpha is always interpolated as it is
+		 */
+		inline void gradient(std::span<Color> out, const Color &from, const Color &to, Space space = Space::linear) noexcept {
+			if (out.empty())
+				return;
+			const auto steps = static_cast<long long>(std::max<size_t>(1, out.size() - 1));
+			const auto lerp = [steps](long long a, long long b, size_t i) {
+				return (a * (steps - static_cast<long long>(i)) + b * static_cast<long long>(i) + steps / 2) / steps;
+			};
+			const auto channel = [&](Uint8 a, Uint8 b, size_t i) -> Uint8 {
+				if (space == Space::srgb)
+					return static_cast<Uint8>(lerp(a, b, i));
+				return kernel::from_linear(static_cast<Uint16>(lerp(kernel::to_linear(a), kernel::to_linear(b), i)));
+			};
+			for (size_t i = 0; i < out.size(); ++i)
+				out[i] = Color(channel(from.r, to.r, i), channel(from.g, to.g, i), channel(from.b, to.b, i),
+				               static_cast<Uint8>(lerp(from.a, to.a, i)));
+		}
 	}
 }
@@ -0,0 +1,420 @@
+#pragma once
+
+#include "const.h"
+#include "except.hpp"
+#include "position.hpp"
+#include "render.hpp"
+#include <vector>
+#include <memory>
+#include <utility>
+#include <span>
+#include <cstring>
+#include <algorithm>
+
+namespace leap {
+	namespace command {
+		/**
+		 * \brief Records render commands to be replayed on a Renderer later, possibly from another thread.
+		 * \details Commands are packed into blocks that are kept across clear() calls, so recording the same
+		 * amount of work every frame does not allocate. Recording never calls SDL, so each worker thread
+		 * can fill its own buffer, while replaying must happen on the thread owning the renderer.
+		 * Textures are recorded as raw handles and must outlive the replay.
+		 */
+		class CommandBuffer {
+			enum class Op : Uint32 {
+				color, blend, clip, viewport, target, clear,
+				copy, point, line, rect, fill_rect,
+				points, points_f, lines, lines_f, rects, rects_f, fill_rects, fill_rects_f,
+				geometry
+			};
+
+			struct Header {
+				Op op;
+				Uint32 size;
+			};
+
+			struct OptionalRect {
+				SDL_Rect rect;
+				bool present;
+			};
+
+			struct Copy {
+				SDL_Texture *texture;
+				OptionalRect src, dst;
+			};
+
+			struct Line {
+				SDL_Point from, to;
+			};
+
+			struct Geometry {
+				SDL_Texture *texture;
+				int num_vertices, num_indices;
+			};
+
+			struct Block {
+				std::unique_ptr<std::byte[]> data;
+				size_t capacity, used;
+			};
+
+			static constexpr size_t alignment = 8;
+
+			static constexpr size_t align(size_t size) noexcept {
+				return (size + alignment - 1) & ~(alignment - 1);
+			}
+
+			std::vector<Block> blocks_;
+			size_t current_ = 0;
+			size_t block_size_;
+			size_t count_ = 0;
+			int order_;
+
+			std::byte *allocate(Op op, size_t payload) {
+				const size_t size = align(sizeof(Header)) + align(payload);
+				while (current_ < blocks_.size() && blocks_[current_].capacity - blocks_[current_].used < size)
+					++current_;
+				if (current_ == blocks_.size()) {
+					const size_t capacity = std::max(block_size_, size);
+					blocks_.push_back(Block{std::make_unique<std::byte[]>(capacity), capacity, 0});
+				}
+				Block &block = blocks_[current_];
+				std::byte *result = block.data.get() + block.used;
+				const Header header{op, static_cast<Uint32>(payload)};
+				std::memcpy(result, &header, sizeof(header));
+				block.used += size;
+				++count_;
+				return result + align(sizeof(Header));
+			}
+
+			template <typename Type>
+			void record(Op op, const Type &payload) {
+				std::memcpy(allocate(op, sizeof(Type)), &payload, sizeof(Type));
+			}
+
+			template <typename Type>
+			void record_span(Op op, std::span<const Type> items) {
+				const int count = static_cast<int>(items.size());
+				std::byte *payload = allocate(op, align(sizeof(int)) + items.size_bytes());
+				std::memcpy(payload, &count, sizeof(int));
+				std::memcpy(payload + align(sizeof(int)), items.data(), items.size_bytes());
+			}
+
+			static OptionalRect optional(const SDL_Rect *rect) noexcept {
+				return rect ? OptionalRect{*rect, true} : OptionalRect{{}, false};
+			}
+
+			template <typename Type>
+			static Type read(const std::byte *payload) noexcept {
+				Type result;
+				std::memcpy(&result, payload, sizeof(Type));
+				return result;
+			}
+
+			template <typename Type>
+			static std::span<const Type> read_span(const std::byte *payload) noexcept {
+				return {reinterpret_cast<const Type *>(payload + align(sizeof(int))),
+				        static_cast<size_t>(read<int>(payload))};
+			}
+
+			static void execute(const render::Renderer &renderer, Op op, const std::byte *payload) {
+				switch (op) {
+				case Op::color:
+					renderer.set_color(read<SDL_Color>(payload));
+					break;
+				case Op::blend:
+					renderer.set_blend_mode(read<SDL_BlendMode>(payload));
+					break;
+				case Op::clip: {
+					const auto clip = read<OptionalRect>(payload);
+					renderer.set_clip(clip.present ? &clip.rect : nullptr);
+					break;
+				}
+				case Op::viewport: {
+					const auto viewport = read<OptionalRect>(payload);
+					renderer.set_viewport(viewport.present ? &viewport.rect : nullptr);
+					break;
+				}
+				case Op::target:
+					renderer.set_target(read<SDL_Texture *>(payload));
+					break;
+				case Op::clear:
+					renderer.clear();
+					break;
+				case Op::copy: {
+					const auto copy = read<Copy>(payload);
+					renderer.copy(copy.texture, copy.src.present ? &copy.src.rect : nullptr,
+					              copy.dst.present ? &copy.dst.rect : nullptr);
+					break;
+				}
+				case Op::point: {
+					const auto point = read<SDL_Point>(payload);
+					renderer.draw_point(point.x, point.y);
+					break;
+				}
+				case Op::line: {
+					const auto line = read<Line>(payload);
+					renderer.draw_line(line.from.x, line.from.y, line.to.x, line.to.y);
+					break;
+				}
+				case Op::rect: {
+					const auto rect = read<SDL_Rect>(payload);
+					renderer.draw_rect(&rect);
+					break;
+				}
+				case Op::fill_rect: {
+					const auto rect = read<SDL_Rect>(payload);
+					renderer.fill_rect(&rect);
+					break;
+				}
+				case Op::points:
+					renderer.draw_points(read_span<pos::IPoint>(payload));
+					break;
+				case Op::points_f:
+					renderer.draw_points(read_span<pos::FPoint>(payload));
+					break;
+				case Op::lines:
+					renderer.draw_lines(read_span<pos::IPoint>(payload));
+					break;
+				case Op::lines_f:
+					renderer.draw_lines(read_span<pos::FPoint>(payload));
+					break;
+				case Op::rects:
+					renderer.draw_rects(read_span<pos::IRect>(payload));
+					break;
+				case Op::rects_f:
+					renderer.draw_rects(read_span<pos::FRect>(payload));
+					break;
+				case Op::fill_rects:
+					renderer.fill_rects(read_span<pos::IRect>(payload));
+					break;
+				case Op::fill_rects_f:
+					renderer.fill_rects(read_span<pos::FRect>(payload));
+					break;
+				case Op::geometry: {
+					const auto geometry = read<Geometry>(payload);
+					const auto vertices = reinterpret_cast<const SDL_Vertex *>(payload + align(sizeof(Geometry)));
+					const auto indices = reinterpret_cast<const int *>(
+						payload + align(sizeof(Geometry)) + align(sizeof(SDL_Vertex) * geometry.num_vertices));
+					renderer.geometry(geometry.texture, vertices, geometry.num_vertices,
+					                  geometry.num_indices ? indices : nullptr, geometry.num_indices);
+					break;
+				}
+				}
+			}
+
+		public:
+			/**
+			 * \param order the position of the buffer when replayed together with others, lower goes first
+			 * \param block_size the size of each memory block in bytes
+			 */
+			explicit CommandBuffer(int order = 0, size_t block_size = 64 * 1024) :
+				block_size_(block_size), order_(order) {
+				blocks_.push_back(Block{std::make_unique<std::byte[]>(block_size), block_size, 0});
+			}
+
+			CommandBuffer(const CommandBuffer &) = delete;
+
+			/**
+			 * \brief takes the blocks of \c other, which is left empty and records into new blocks
+			 */
+			CommandBuffer(CommandBuffer &&other) noexcept :
+				blocks_(std::move(other.blocks_)), current_(std::exchange(other.current_, 0)),
+				block_size_(other.block_size_), count_(std::exchange(other.count_, 0)), order_(other.order_) {
+				other.blocks_.clear();
+			}
+
+			CommandBuffer &operator=(CommandBuffer &&other) noexcept {
+				if (this != &other) {
+					blocks_ = std::move(other.blocks_);
+					other.blocks_.clear();
+					current_ = std::exchange(other.current_, 0);
+					block_size_ = other.block_size_;
+					count_ = std::exchange(other.count_, 0);
+					order_ = other.order_;
+				}
+				return *this;
+			}
+
+			void set_color(const SDL_Color &color) {
+				record(Op::color, color);
+			}
+
+			void set_color(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+				set_color(SDL_Color{r, g, b, a});
+			}
+
+			void set_blend_mode(SDL_BlendMode mode) {
+				record(Op::blend, mode);
+			}
+
+			void set_clip(const SDL_Rect *rect) {
+				record(Op::clip, optional(rect));
+			}
+
+			void set_clip(const pos::IRect &rect) {
+				set_clip(static_cast<const SDL_Rect *>(&rect));
+			}
+
+			void reset_clip() {
+				set_clip(nullptr);
+			}
+
+			void set_viewport(const SDL_Rect *rect) {
+				record(Op::viewport, optional(rect));
+			}
+
+			void set_viewport(const pos::IRect &rect) {
+				set_viewport(static_cast<const SDL_Rect *>(&rect));
+			}
+
+			void reset_viewport() {
+				set_viewport(nullptr);
+			}
+
+			void set_target(SDL_Texture *texture) {
+				record(Op::target, texture);
+			}
+
+			void reset_target() {
+				set_target(nullptr);
+			}
+
+			void clear() {
+				allocate(Op::clear, 0);
+			}
+
+			void copy(SDL_Texture *texture, const SDL_Rect *src = nullptr, const SDL_Rect *dst = nullptr) {
+				record(Op::copy, Copy{texture, optional(src), optional(dst)});
+			}
+
+			void copy(SDL_Texture *texture, const pos::IRect &src, const pos::IRect &dst) {
+				copy(texture, &src, &dst);
+			}
+
+			void draw_point(const pos::IPoint &point) {
+				record(Op::point, static_cast<const SDL_Point &>(point));
+			}
+
+			void draw_line(const pos::IPoint &from, const pos::IPoint &to) {
+				record(Op::line, Line{from, to});
+			}
+
+			void draw_rect(const pos::IRect &rect) {
+				record(Op::rect, static_cast<const SDL_Rect &>(rect));
+			}
+
+			void fill_rect(const pos::IRect &rect) {
+				record(Op::fill_rect, static_cast<const SDL_Rect &>(rect));
+			}
+
+			void draw_points(std::span<const pos::IPoint> points) {
+				record_span(Op::points, points);
+			}
+
+			void draw_points(std::span<const pos::FPoint> points) {
+				record_span(Op::points_f, points);
+			}
+
+			void draw_lines(std::span<const pos::IPoint> points) {
+				record_span(Op::lines, points);
+			}
+
+			void draw_lines(std::span<const pos::FPoint> points) {
+				record_span(Op::lines_f, points);
+			}
+
+			void draw_rects(std::span<const pos::IRect> rects) {
+				record_span(Op::rects, rects);
+			}
+
+			void draw_rects(std::span<const pos::FRect> rects) {
+				record_span(Op::rects_f, rects);
+			}
+
+			void fill_rects(std::span<const pos::IRect> rects) {
+				record_span(Op::fill_rects, rects);
+			}
+
+			void fill_rects(std::span<const pos::FRect> rects) {
+				record_span(Op::fill_rects_f, rects);
+			}
+
+			void geometry(SDL_Texture *texture, std::span<const SDL_Vertex> vertices, std::span<const int> indices = {}) {
+				const Geometry geometry{texture, static_cast<int>(vertices.size()), static_cast<int>(indices.size())};
+				std::byte *payload = allocate(Op::geometry, align(sizeof(Geometry)) + align(vertices.size_bytes()) +
+				                                            indices.size_bytes());
+				std::memcpy(payload, &geometry, sizeof(Geometry));
+				payload += align(sizeof(Geometry));
+				std::memcpy(payload, vertices.data(), vertices.size_bytes());
+				payload += align(vertices.size_bytes());
+				if (!indices.empty())
+					std::memcpy(payload, indices.data(), indices.size_bytes());
+			}
+
+			/**
+			 * \brief executes every recorded command in order
+			 * \param renderer the renderer to draw with, only usable on its own thread
+			 */
+			void replay(const render::Renderer &renderer) const {
+				for (size_t i = 0; i <= current_ && i < blocks_.size(); ++i) {
+					const Block &block = blocks_[i];
+					for (size_t offset = 0; offset < block.used;) {
+						const std::byte *record = block.data.get() + offset;
+						const auto header = read<Header>(record);
+						execute(renderer, header.op, record + align(sizeof(Header)));
+						offset += align(sizeof(Header)) + align(header.size);
+					}
+				}
+			}
+
+			/**
+			 * \brief forgets every recorded command, keeping the memory for the next frame
+			 */
+			void reset() noexcept {
+				for (auto &block : blocks_)
+					block.used = 0;
+				current_ = 0;
+				count_ = 0;
+			}
+
+			size_t size() const noexcept {
+				return count_;
+			}
+
+			bool empty() const noexcept {
+				return count_ == 0;
+			}
+
+			/**
+			 * \brief the bytes reserved by the buffer, which stay allocated after reset()
+			 */
+			size_t capacity() const noexcept {
+				size_t result = 0;
+				for (const auto &block : blocks_)
+					result += block.capacity;
+				return result;
+			}
+
+			int order() const noexcept {
+				return order_;
+			}
+
+			void set_order(int order) noexcept {
+				order_ = order;
+			}
+		};
+
+		/**
+		 * \brief replays several buffers by their order, buffers of the same order keep their relative position
+		 * \param renderer the renderer to draw with
+		 * \param buffers the buffers to replay, sorted in place
+		 */
+		inline void replay(const render::Renderer &renderer, std::span<CommandBuffer *> buffers) {
+			std::stable_sort(buffers.begin(), buffers.end(), [](const CommandBuffer *lhs, const CommandBuffer *rhs) {
+				return lhs->order() < rhs->order();
+			});
+			for (const auto buffer : buffers)
+				buffer->replay(renderer);
+		}
+	}
+}
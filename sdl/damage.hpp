@@ -0,0 +1,110 @@
+#pragma once
+
+#include "const.h"
+#include "position.hpp"
+#include "region.hpp"
+#include <vector>
+
+namespace leap {
+	namespace damage {
+		/**
+		 * \brief A small set of rectangles that need a redraw.
+		 * \details Rectangles are merged whenever their bounding rectangle costs no more area than the two of them,
+		 * so touching and overlapping updates become one. Once there are more than \c limit rectangles,
+		 * everything is merged into the bounding rectangle, since many small redraws cost more than one large one.
+		 */
+		class Damage {
+			std::vector<pos::IRect> rects_;
+			size_t limit_;
+
+			static bool worth_merging(const pos::IRect &lhs, const pos::IRect &rhs) noexcept {
+				return lhs.united(rhs).area() <= lhs.area() + rhs.area();
+			}
+
+		public:
+			explicit Damage(size_t limit = 16) : limit_(limit) {
+				rects_.reserve(limit + 1);
+			}
+
+			/**
+			 * \brief adds a rectangle to the damaged area
+			 * \param rect the rectangle, empty rectangles are ignored
+			 */
+			void add(const pos::IRect &rect) {
+				if (rect.empty())
+					return;
+				pos::IRect merged = rect;
+				for (size_t i = 0; i < rects_.size();) {
+					if (worth_merging(rects_[i], merged)) {
+						merged = merged.united(rects_[i]);
+						rects_[i] = rects_.back();
+						rects_.pop_back();
+						// the grown rectangle may now be worth merging with the ones already checked
+						i = 0;
+					}
+					else
+						++i;
+				}
+				rects_.push_back(merged);
+				if (rects_.size() > limit_) {
+					const auto all = bounds();
+					rects_.clear();
+					rects_.push_back(all);
+				}
+			}
+
+			void add(const Damage &damage) {
+				for (const auto &rect : damage.rects_)
+					add(rect);
+			}
+
+			void clear() noexcept {
+				rects_.clear();
+			}
+
+			bool empty() const noexcept {
+				return rects_.empty();
+			}
+
+			/**
+			 * \brief checks whether any damaged rectangle overlaps \c rect
+			 */
+			bool intersects(const pos::IRect &rect) const noexcept {
+				for (const auto &damaged : rects_)
+					if (damaged.intersects(rect))
+						return true;
+				return false;
+			}
+
+			/**
+			 * \brief returns the smallest rectangle containing every damaged rectangle
+			 */
+			pos::IRect bounds() const noexcept {
+				pos::IRect result;
+				for (const auto &rect : rects_)
+					result = result.united(rect);
+				return result;
+			}
+
+			/**
+			 * \brief the damaged area as a region, whose rectangles do not overlap, to redraw each pixel once
+			 * or to clip against
+			 */
+			pos::Region region() const {
+				return pos::Region(rects_);
+			}
+
+			void add(const pos::Region &region) {
+				for (const auto &rect : region)
+					add(rect);
+			}
+
+			/**
+			 * \brief the damaged rectangles, which may overlap each other
+			 */
+			const std::vector<pos::IRect> &rects() const noexcept {
+				return rects_;
+			}
+		};
+	}
+}
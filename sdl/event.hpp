@@ -1,5 +1,10 @@
+#pragma once
+
 #include "const.h"
+#include "except.hpp"
 #include "position.hpp"
+#include <vector>
+#include <functional>
 
 namespace leap::event {
 	class Event {
@@ -42,4 +47,192 @@ namespace leap::event {
 			return event_;
 		}
 	};
+
+	/**
+	 * \brief Drains every pending event at once into a ring buffer, and dispatches them by type to handlers.
+	 * \details Events are taken from SDL in bulk by SDL_PeepEvents, which must happen on the thread that set
+	 * the video mode. Handlers are found through a table indexed by event type, so dispatch costs the same for
+	 * any number of types handled. Consecutive SDL_MOUSEMOTION events of the same mouse, window and buttons
+	 * collapse into the last one, with their relative motion added up, so a flood of motion costs one handler
+	 * call per frame.
+	 */
+	class Pump {
+	public:
+		using Handler = std::function<void(const SDL_Event &)>;
+
+	private:
+		static constexpr size_t types = static_cast<size_t>(SDL_LASTEVENT) + 1;
+		// events taken from SDL per SDL_PeepEvents call
+		static constexpr int chunk = 64;
+
+		std::vector<SDL_Event> ring_;
+		// the ring holds ring_[head_ & mask], ..., ring_[(head_ + size_ - 1) & mask], its size being a power of 2
+		size_t head_ = 0, size_ = 0;
+		SDL_Event scratch_[chunk];
+
+		// the slot of the handlers of each type, 0 for types without handlers
+		std::vector<Uint8> slots_;
+		std::vector<std::vector<Handler>> handlers_;
+		Handler fallback_;
+
+		bool coalesce_motion_ = true;
+		size_t coalesced_ = 0;
+
+		SDL_Event &at(size_t i) noexcept {
+			return ring_[(head_ + i) & (ring_.size() - 1)];
+		}
+
+		void grow() {
+			std::vector<SDL_Event> bigger(ring_.size() * 2);
+			for (size_t i = 0; i < size_; ++i)
+				bigger[i] = at(i);
+			ring_.swap(bigger);
+			head_ = 0;
+		}
+
+	public:
+		/**
+		 * \param capacity the number of events the ring holds before it grows, rounded up to a power of 2
+		 */
+		explicit Pump(size_t capacity = 256) : slots_(types, 0), handlers_(1) {
+			size_t size = 1;
+			while (size < capacity)
+				size *= 2;
+			ring_.resize(size);
+		}
+
+		Pump(const Pump &) = delete;
+
+		/**
+		 * \brief puts an event at the end of the ring, merging it into the last one if both are motion
+		 */
+		void add(const SDL_Event &event) {
+			if (coalesce_motion_ && event.type == SDL_MOUSEMOTION && size_ != 0) {
+				SDL_MouseMotionEvent &last = at(size_ - 1).motion;
+				const SDL_MouseMotionEvent &motion = event.motion;
+				if (last.type == SDL_MOUSEMOTION && last.windowID == motion.windowID && last.which == motion.which &&
+				    last.state == motion.state) {
+					const Sint32 xrel = last.xrel + motion.xrel, yrel = last.yrel + motion.yrel;
+					last = motion;
+					last.xrel = xrel;
+					last.yrel = yrel;
+					++coalesced_;
+					return;
+				}
+			}
+			if (size_ == ring_.size())
+				grow();
+			at(size_++) = event;
+		}
+
+		/**
+		 * \brief adds a handler of the events of \c type, after the ones added before
+		 * \throw LeapException if handlers are already set for 255 types
+		 */
+		void on(Uint32 type, Handler handler) {
+			Uint8 &slot = slots_[type & SDL_LASTEVENT];
+			if (slot == 0) {
+				if (handlers_.size() > 255)
+					throw except::LeapException("too many event types handled");
+				slot = static_cast<Uint8>(handlers_.size());
+				handlers_.emplace_back();
+			}
+			handlers_[slot].push_back(std::move(handler));
+		}
+
+		/**
+		 * \brief removes the handlers of \c type
+		 */
+		void clear(Uint32 type) noexcept {
+			const Uint8 slot = slots_[type & SDL_LASTEVENT];
+			if (slot != 0)
+				handlers_[slot].clear();
+		}
+
+		/**
+		 * \brief sets the handler of the events of types without handlers
+		 */
+		void set_fallback(Handler handler) {
+			fallback_ = std::move(handler);
+		}
+
+		void set_coalesce_motion(bool coalesce) noexcept {
+			coalesce_motion_ = coalesce;
+		}
+
+		/**
+		 * \brief the number of motion events merged into others since the start
+		 */
+		size_t coalesced() const noexcept {
+			return coalesced_;
+		}
+
+		/**
+		 * \brief takes every event pending in SDL into the ring
+		 * \return the number of events in the ring
+		 */
+		size_t poll() {
+			SDL_PumpEvents();
+			while (true) {
+				const int count = SDL_PeepEvents(scratch_, chunk, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+				if (count < 0)
+					except::throw_exc();
+				for (int i = 0; i < count; ++i)
+					add(scratch_[i]);
+				if (count < chunk)
+					break;
+			}
+			return size_;
+		}
+
+		/**
+		 * \brief takes the oldest event out of the ring
+		 * \return whether there was one
+		 */
+		bool next(SDL_Event &event) noexcept {
+			if (size_ == 0)
+				return false;
+			event = at(0);
+			head_ = (head_ + 1) & (ring_.size() - 1);
+			--size_;
+			return true;
+		}
+
+		/**
+		 * \brief passes every event in the ring to its handlers, oldest first
+		 * \details events pushed by the handlers wait for the next poll
+		 * \return the number of events dispatched
+		 */
+		size_t dispatch() {
+			size_t count = 0;
+			SDL_Event event;
+			while (next(event)) {
+				const auto &handlers = handlers_[slots_[event.type & SDL_LASTEVENT]];
+				if (!handlers.empty())
+					for (const auto &handler : handlers)
+						handler(event);
+				else if (fallback_)
+					fallback_(event);
+				++count;
+			}
+			return count;
+		}
+
+		/**
+		 * \brief polls and dispatches every pending event, once per frame
+		 * \return the number of events dispatched
+		 */
+		size_t pump() {
+			poll();
+			return dispatch();
+		}
+
+		size_t size() const noexcept {
+			return size_;
+		}
+
+		bool empty() const noexcept {
+			return size_ == 0;
+		}
+	};
 }
@@ -0,0 +1,741 @@
+#pragma once
+
+#include "const.h"
+#include "except.hpp"
+#include "position.hpp"
+#include "kernel.hpp"
+#include <span>
+#include <vector>
+#include <limits>
+#include <cstring>
+#include <algorithm>
+
+namespace leap {
+	namespace pos {
+		/*
+		 * Points and rectangles stored as structures of arrays, one array per field, so that an operation on all
+		 * of them runs 4 at a time in SSE2 on x86, following kernel::isa, and gives the same result as the loop
+		 * over Point and Rect it replaces. Tests write one byte per element, 1 where the test holds, 0 elsewhere.
+		 */
+
+		namespace detail {
+#ifdef LEAP_KERNEL_X86
+			template <typename Arithmetic>
+			struct Lanes;
+
+			template <>
+			struct Lanes<int> {
+				using Vector = __m128i;
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector load(const int *p) noexcept {
+					return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static void store(int *p, Vector v) noexcept {
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector set1(int value) noexcept {
+					return _mm_set1_epi32(value);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector add(Vector a, Vector b) noexcept {
+					return _mm_add_epi32(a, b);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector sub(Vector a, Vector b) noexcept {
+					return _mm_sub_epi32(a, b);
+				}
+
+				// SSE2 multiplies 2 lanes at once into 64 bits, whose low halves are the products wanted
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector mul(Vector a, Vector b) noexcept {
+					const __m128i even = _mm_mul_epu32(a, b);
+					const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+					return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+					                          _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector lt(Vector a, Vector b) noexcept {
+					return _mm_cmplt_epi32(a, b);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector le(Vector a, Vector b) noexcept {
+					return _mm_xor_si128(_mm_cmpgt_epi32(a, b), _mm_set1_epi32(-1));
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector both(Vector a, Vector b) noexcept {
+					return _mm_and_si128(a, b);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector select(Vector mask, Vector a, Vector b) noexcept {
+					return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector min(Vector a, Vector b) noexcept {
+					return select(_mm_cmplt_epi32(a, b), a, b);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector max(Vector a, Vector b) noexcept {
+					return select(_mm_cmpgt_epi32(a, b), a, b);
+				}
+
+				// the 4 lanes of a mask as the bytes 0 or 1
+				LEAP_KERNEL_TARGET("sse2")
+				static Uint32 bytes(Vector mask) noexcept {
+					const __m128i words = _mm_packs_epi32(mask, mask);
+					return static_cast<Uint32>(_mm_cvtsi128_si32(_mm_packs_epi16(words, words))) & 0x01010101;
+				}
+			};
+
+			template <>
+			struct Lanes<float> {
+				using Vector = __m128;
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector load(const float *p) noexcept {
+					return _mm_loadu_ps(p);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static void store(float *p, Vector v) noexcept {
+					_mm_storeu_ps(p, v);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector set1(float value) noexcept {
+					return _mm_set1_ps(value);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector add(Vector a, Vector b) noexcept {
+					return _mm_add_ps(a, b);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector sub(Vector a, Vector b) noexcept {
+					return _mm_sub_ps(a, b);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector mul(Vector a, Vector b) noexcept {
+					return _mm_mul_ps(a, b);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector lt(Vector a, Vector b) noexcept {
+					return _mm_cmplt_ps(a, b);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector le(Vector a, Vector b) noexcept {
+					return _mm_cmple_ps(a, b);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector both(Vector a, Vector b) noexcept {
+					return _mm_and_ps(a, b);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector select(Vector mask, Vector a, Vector b) noexcept {
+					return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+				}
+
+				// written as selects rather than _mm_min_ps, so that they match std::min and std::max
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector min(Vector a, Vector b) noexcept {
+					return select(_mm_cmplt_ps(b, a), b, a);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Vector max(Vector a, Vector b) noexcept {
+					return select(_mm_cmplt_ps(a, b), b, a);
+				}
+
+				LEAP_KERNEL_TARGET("sse2")
+				static Uint32 bytes(Vector mask) noexcept {
+					return Lanes<int>::bytes(_mm_castps_si128(mask));
+				}
+			};
+
+			// p = (p - origin) * m + origin
+			template <typename Arithmetic>
+			LEAP_KERNEL_TARGET("sse2")
+			size_t scale_sse2(Arithmetic *p, size_t n, Arithmetic origin, Arithmetic m) noexcept {
+				using L = Lanes<Arithmetic>;
+				const auto o = L::set1(origin), f = L::set1(m);
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+					L::store(p + i, L::add(L::mul(f, L::sub(L::load(p + i), o)), o));
+				return i;
+			}
+
+			template <typename Arithmetic>
+			LEAP_KERNEL_TARGET("sse2")
+			size_t offset_sse2(Arithmetic *p, size_t n, Arithmetic d) noexcept {
+				using L = Lanes<Arithmetic>;
+				const auto v = L::set1(d);
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+					L::store(p + i, L::add(L::load(p + i), v));
+				return i;
+			}
+
+			// whether each point is in [x0, x1] x [y0, y1], the bounds included
+			template <typename Arithmetic>
+			LEAP_KERNEL_TARGET("sse2")
+			size_t inside_sse2(const Arithmetic *xs, const Arithmetic *ys, size_t n, Arithmetic x0, Arithmetic y0,
+			                   Arithmetic x1, Arithmetic y1, Uint8 *mask) noexcept {
+				using L = Lanes<Arithmetic>;
+				const auto left = L::set1(x0), top = L::set1(y0), right = L::set1(x1), bottom = L::set1(y1);
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					const auto x = L::load(xs + i), y = L::load(ys + i);
+					const Uint32 bytes = L::bytes(L::both(L::both(L::le(left, x), L::le(x, right)),
+					                                      L::both(L::le(top, y), L::le(y, bottom))));
+					std::memcpy(mask + i, &bytes, 4);
+				}
+				return i;
+			}
+
+			// whether each rectangle contains (px, py), the right and bottom edges included
+			template <typename Arithmetic>
+			LEAP_KERNEL_TARGET("sse2")
+			size_t contains_sse2(const Arithmetic *xs, const Arithmetic *ys, const Arithmetic *ws, const Arithmetic *hs,
+			                     size_t n, Arithmetic px, Arithmetic py, Uint8 *mask) noexcept {
+				using L = Lanes<Arithmetic>;
+				const auto x = L::set1(px), y = L::set1(py);
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					const auto left = L::load(xs + i), top = L::load(ys + i);
+					const auto right = L::add(left, L::load(ws + i)), bottom = L::add(top, L::load(hs + i));
+					const Uint32 bytes = L::bytes(L::both(L::both(L::le(left, x), L::le(x, right)),
+					                                      L::both(L::le(top, y), L::le(y, bottom))));
+					std::memcpy(mask + i, &bytes, 4);
+				}
+				return i;
+			}
+
+			// whether each rectangle shares area with the non-empty [x0, x1) x [y0, y1)
+			template <typename Arithmetic>
+			LEAP_KERNEL_TARGET("sse2")
+			size_t intersects_sse2(const Arithmetic *xs, const Arithmetic *ys, const Arithmetic *ws, const Arithmetic *hs,
+			                       size_t n, Arithmetic x0, Arithmetic y0, Arithmetic x1, Arithmetic y1, Uint8 *mask) noexcept {
+				using L = Lanes<Arithmetic>;
+				const auto left = L::set1(x0), top = L::set1(y0), right = L::set1(x1), bottom = L::set1(y1);
+				const auto zero = L::set1(0);
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					const auto x = L::load(xs + i), y = L::load(ys + i), w = L::load(ws + i), h = L::load(hs + i);
+					const auto filled = L::both(L::lt(zero, w), L::lt(zero, h));
+					const auto overlap = L::both(L::both(L::lt(x, right), L::lt(left, L::add(x, w))),
+					                             L::both(L::lt(y, bottom), L::lt(top, L::add(y, h))));
+					const Uint32 bytes = L::bytes(L::both(filled, overlap));
+					std::memcpy(mask + i, &bytes, 4);
+				}
+				return i;
+			}
+
+			// intersects each rectangle with the non-empty [x0, x1) x [y0, y1), as Rect::intersection
+			template <typename Arithmetic>
+			LEAP_KERNEL_TARGET("sse2")
+			size_t clip_sse2(Arithmetic *xs, Arithmetic *ys, Arithmetic *ws, Arithmetic *hs, size_t n,
+			                 Arithmetic x0, Arithmetic y0, Arithmetic x1, Arithmetic y1) noexcept {
+				using L = Lanes<Arithmetic>;
+				const auto left = L::set1(x0), top = L::set1(y0), right = L::set1(x1), bottom = L::set1(y1);
+				const auto zero = L::set1(0);
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					const auto x = L::load(xs + i), y = L::load(ys + i), w = L::load(ws + i), h = L::load(hs + i);
+					const auto x_end = L::add(x, w), y_end = L::add(y, h);
+					const auto keep = L::both(L::both(L::both(L::lt(zero, w), L::lt(zero, h)),
+					                                  L::both(L::lt(x, right), L::lt(left, x_end))),
+					                          L::both(L::lt(y, bottom), L::lt(top, y_end)));
+					const auto cx = L::max(x, left), cy = L::max(y, top);
+					L::store(xs + i, L::select(keep, cx, zero));
+					L::store(ys + i, L::select(keep, cy, zero));
+					L::store(ws + i, L::select(keep, L::sub(L::min(x_end, right), cx), zero));
+					L::store(hs + i, L::select(keep, L::sub(L::min(y_end, bottom), cy), zero));
+				}
+				return i;
+			}
+
+			// the bounds of the non-empty rectangles, starting from left, top, right and bottom
+			template <typename Arithmetic>
+			LEAP_KERNEL_TARGET("sse2")
+			size_t bounds_sse2(const Arithmetic *xs, const Arithmetic *ys, const Arithmetic *ws, const Arithmetic *hs,
+			                   size_t n, Arithmetic (&bounds)[4]) noexcept {
+				using L = Lanes<Arithmetic>;
+				auto left = L::set1(bounds[0]), top = L::set1(bounds[1]), right = L::set1(bounds[2]), bottom = L::set1(bounds[3]);
+				const auto zero = L::set1(0);
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					const auto x = L::load(xs + i), y = L::load(ys + i), w = L::load(ws + i), h = L::load(hs + i);
+					const auto filled = L::both(L::lt(zero, w), L::lt(zero, h));
+					left = L::select(filled, L::min(left, x), left);
+					top = L::select(filled, L::min(top, y), top);
+					right = L::select(filled, L::max(right, L::add(x, w)), right);
+					bottom = L::select(filled, L::max(bottom, L::add(y, h)), bottom);
+				}
+				alignas(16) Arithmetic lanes[4][4];
+				L::store(lanes[0], left);
+				L::store(lanes[1], top);
+				L::store(lanes[2], right);
+				L::store(lanes[3], bottom);
+				for (int lane = 0; lane < 4; ++lane) {
+					bounds[0] = std::min(bounds[0], lanes[0][lane]);
+					bounds[1] = std::min(bounds[1], lanes[1][lane]);
+					bounds[2] = std::max(bounds[2], lanes[2][lane]);
+					bounds[3] = std::max(bounds[3], lanes[3][lane]);
+				}
+				return i;
+			}
+
+			// the least of low and the greatest of high, starting from least and greatest
+			template <typename Arithmetic>
+			LEAP_KERNEL_TARGET("sse2")
+			size_t extent_sse2(const Arithmetic *low, const Arithmetic *high, size_t n, Arithmetic &least,
+			                   Arithmetic &greatest) noexcept {
+				using L = Lanes<Arithmetic>;
+				auto min = L::set1(least), max = L::set1(greatest);
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					min = L::min(min, L::load(low + i));
+					max = L::max(max, L::load(high + i));
+				}
+				alignas(16) Arithmetic lanes[8];
+				L::store(lanes, min);
+				L::store(lanes + 4, max);
+				for (int lane = 0; lane < 4; ++lane) {
+					least = std::min(least, lanes[lane]);
+					greatest = std::max(greatest, lanes[lane + 4]);
+				}
+				return i;
+			}
+#endif
+
+			template <typename Arithmetic>
+			void scale(Arithmetic *p, size_t n, Arithmetic origin, Arithmetic m) noexcept {
+				size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+				if (kernel::isa() != kernel::Isa::scalar)
+					i = scale_sse2(p, n, origin, m);
+#endif
+				for (; i < n; ++i)
+					p[i] = m * (p[i] - origin) + origin;
+			}
+
+			template <typename Arithmetic>
+			void offset(Arithmetic *p, size_t n, Arithmetic d) noexcept {
+				size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+				if (kernel::isa() != kernel::Isa::scalar)
+					i = offset_sse2(p, n, d);
+#endif
+				for (; i < n; ++i)
+					p[i] += d;
+			}
+
+			template <typename Arithmetic>
+			void extent(const Arithmetic *low, const Arithmetic *high, size_t n, Arithmetic &least,
+			            Arithmetic &greatest) noexcept {
+				size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+				if (kernel::isa() != kernel::Isa::scalar)
+					i = extent_sse2(low, high, n, least, greatest);
+#endif
+				for (; i < n; ++i) {
+					least = std::min(least, low[i]);
+					greatest = std::max(greatest, high[i]);
+				}
+			}
+		}
+
+		/**
+		 * \brief Points as an array of x and an array of y.
+		 */
+		template <typename Arithmetic>
+		class PointArray {
+			using PointType = Point<Arithmetic>;
+			using RectType = Rect<Arithmetic>;
+
+			std::vector<Arithmetic> xs_, ys_;
+
+		public:
+			PointArray() = default;
+
+			explicit PointArray(std::span<const PointType> points) {
+				assign(points);
+			}
+
+			void assign(std::span<const PointType> points) {
+				xs_.resize(points.size());
+				ys_.resize(points.size());
+				for (size_t i = 0; i < points.size(); ++i) {
+					xs_[i] = points[i].x;
+					ys_[i] = points[i].y;
+				}
+			}
+
+			/**
+			 * \brief writes the points into \c points, which must be of the same size
+			 */
+			void store(std::span<PointType> points) const {
+				if (points.size() != size())
+					throw except::LeapException("storing points into a span of another size");
+				for (size_t i = 0; i < points.size(); ++i)
+					points[i] = PointType(xs_[i], ys_[i]);
+			}
+
+			std::vector<PointType> to_points() const {
+				std::vector<PointType> result(size());
+				store(result);
+				return result;
+			}
+
+			void push_back(const PointType &point) {
+				xs_.push_back(point.x);
+				ys_.push_back(point.y);
+			}
+
+			void reserve(size_t n) {
+				xs_.reserve(n);
+				ys_.reserve(n);
+			}
+
+			void clear() noexcept {
+				xs_.clear();
+				ys_.clear();
+			}
+
+			size_t size() const noexcept {
+				return xs_.size();
+			}
+
+			bool empty() const noexcept {
+				return xs_.empty();
+			}
+
+			PointType operator[](size_t i) const noexcept {
+				return PointType(xs_[i], ys_[i]);
+			}
+
+			void set(size_t i, const PointType &point) noexcept {
+				xs_[i] = point.x;
+				ys_[i] = point.y;
+			}
+
+			std::span<Arithmetic> xs() noexcept {
+				return xs_;
+			}
+
+			std::span<const Arithmetic> xs() const noexcept {
+				return xs_;
+			}
+
+			std::span<Arithmetic> ys() noexcept {
+				return ys_;
+			}
+
+			std::span<const Arithmetic> ys() const noexcept {
+				return ys_;
+			}
+
+			void translate(const PointType &offset) noexcept {
+				detail::offset(xs_.data(), size(), offset.x);
+				detail::offset(ys_.data(), size(), offset.y);
+			}
+
+			/**
+			 * \brief moves every point \c m times as far from \c origin, as Rect::expand moves corners
+			 */
+			void expand(const PointType &origin, Arithmetic m) noexcept {
+				detail::scale(xs_.data(), size(), origin.x, m);
+				detail::scale(ys_.data(), size(), origin.y, m);
+			}
+
+			/**
+			 * \brief tests each point against \c rect as Rect::contains, the right and bottom edges included
+			 * \param mask a byte per point
+			 */
+			void inside(const RectType &rect, std::span<Uint8> mask) const {
+				if (mask.size() != size())
+					throw except::LeapException("the mask must have a byte per point");
+				const Arithmetic x0 = rect.x, y0 = rect.y, x1 = rect.x + rect.w, y1 = rect.y + rect.h;
+				size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+				if (kernel::isa() != kernel::Isa::scalar)
+					i = detail::inside_sse2(xs_.data(), ys_.data(), size(), x0, y0, x1, y1, mask.data());
+#endif
+				for (; i < size(); ++i)
+					mask[i] = x0 <= xs_[i] && xs_[i] <= x1 && y0 <= ys_[i] && ys_[i] <= y1;
+			}
+
+			std::vector<Uint8> inside(const RectType &rect) const {
+				std::vector<Uint8> mask(size());
+				inside(rect, mask);
+				return mask;
+			}
+
+			/**
+			 * \return the smallest rectangle with every point on it or inside, or an empty rectangle if there are
+			 * no points
+			 */
+			RectType bounds() const noexcept {
+				if (empty())
+					return {};
+				Arithmetic left = xs_[0], right = xs_[0], top = ys_[0], bottom = ys_[0];
+				detail::extent(xs_.data(), xs_.data(), size(), left, right);
+				detail::extent(ys_.data(), ys_.data(), size(), top, bottom);
+				return RectType(PointType(left, top), PointType(right, bottom));
+			}
+		};
+
+		/**
+		 * \brief Rectangles as arrays of x, y, w and h.
+		 */
+		template <typename Arithmetic>
+		class RectArray {
+			using PointType = Point<Arithmetic>;
+			using RectType = Rect<Arithmetic>;
+
+			std::vector<Arithmetic> xs_, ys_, ws_, hs_;
+
+		public:
+			RectArray() = default;
+
+			explicit RectArray(std::span<const RectType> rects) {
+				assign(rects);
+			}
+
+			void assign(std::span<const RectType> rects) {
+				xs_.resize(rects.size());
+				ys_.resize(rects.size());
+				ws_.resize(rects.size());
+				hs_.resize(rects.size());
+				for (size_t i = 0; i < rects.size(); ++i) {
+					xs_[i] = rects[i].x;
+					ys_[i] = rects[i].y;
+					ws_[i] = rects[i].w;
+					hs_[i] = rects[i].h;
+				}
+			}
+
+			/**
+			 * \brief writes the rectangles into \c rects, which must be of the same size
+			 */
+			void store(std::span<RectType> rects) const {
+				if (rects.size() != size())
+					throw except::LeapException("storing rectangles into a span of another size");
+				for (size_t i = 0; i < rects.size(); ++i)
+					rects[i] = RectType(xs_[i], ys_[i], ws_[i], hs_[i]);
+			}
+
+			std::vector<RectType> to_rects() const {
+				std::vector<RectType> result(size());
+				store(result);
+				return result;
+			}
+
+			void push_back(const RectType &rect) {
+				xs_.push_back(rect.x);
+				ys_.push_back(rect.y);
+				ws_.push_back(rect.w);
+				hs_.push_back(rect.h);
+			}
+
+			void reserve(size_t n) {
+				xs_.reserve(n);
+				ys_.reserve(n);
+				ws_.reserve(n);
+				hs_.reserve(n);
+			}
+
+			void clear() noexcept {
+				xs_.clear();
+				ys_.clear();
+				ws_.clear();
+				hs_.clear();
+			}
+
+			size_t size() const noexcept {
+				return xs_.size();
+			}
+
+			bool empty() const noexcept {
+				return xs_.empty();
+			}
+
+			RectType operator[](size_t i) const noexcept {
+				return RectType(xs_[i], ys_[i], ws_[i], hs_[i]);
+			}
+
+			void set(size_t i, const RectType &rect) noexcept {
+				xs_[i] = rect.x;
+				ys_[i] = rect.y;
+				ws_[i] = rect.w;
+				hs_[i] = rect.h;
+			}
+
+			std::span<Arithmetic> xs() noexcept {
+				return xs_;
+			}
+
+			std::span<const Arithmetic> xs() const noexcept {
+				return xs_;
+			}
+
+			std::span<Arithmetic> ys() noexcept {
+				return ys_;
+			}
+
+			std::span<const Arithmetic> ys() const noexcept {
+				return ys_;
+			}
+
+			std::span<Arithmetic> ws() noexcept {
+				return ws_;
+			}
+
+			std::span<const Arithmetic> ws() const noexcept {
+				return ws_;
+			}
+
+			std::span<Arithmetic> hs() noexcept {
+				return hs_;
+			}
+
+			std::span<const Arithmetic> hs() const noexcept {
+				return hs_;
+			}
+
+			void translate(const PointType &offset) noexcept {
+				detail::offset(xs_.data(), size(), offset.x);
+				detail::offset(ys_.data(), size(), offset.y);
+			}
+
+			/**
+			 * \brief expands every rectangle \c m times about \c origin, as Rect::expand
+			 */
+			void expand(const PointType &origin, Arithmetic m) noexcept {
+				detail::scale(xs_.data(), size(), origin.x, m);
+				detail::scale(ys_.data(), size(), origin.y, m);
+				detail::scale(ws_.data(), size(), Arithmetic(0), m);
+				detail::scale(hs_.data(), size(), Arithmetic(0), m);
+			}
+
+			/**
+			 * \brief tests whether each rectangle contains \c point, as Rect::contains
+			 * \param mask a byte per rectangle
+			 */
+			void contains(const PointType &point, std::span<Uint8> mask) const {
+				if (mask.size() != size())
+					throw except::LeapException("the mask must have a byte per rectangle");
+				size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+				if (kernel::isa() != kernel::Isa::scalar)
+					i = detail::contains_sse2(xs_.data(), ys_.data(), ws_.data(), hs_.data(), size(), point.x, point.y, mask.data());
+#endif
+				for (; i < size(); ++i)
+					mask[i] = (*this)[i].contains(point);
+			}
+
+			std::vector<Uint8> contains(const PointType &point) const {
+				std::vector<Uint8> mask(size());
+				contains(point, mask);
+				return mask;
+			}
+
+			/**
+			 * \brief tests whether each rectangle shares area with \c rect, as Rect::intersects
+			 * \param mask a byte per rectangle
+			 */
+			void intersects(const RectType &rect, std::span<Uint8> mask) const {
+				if (mask.size() != size())
+					throw except::LeapException("the mask must have a byte per rectangle");
+				if (rect.empty()) {
+					std::fill(mask.begin(), mask.end(), Uint8(0));
+					return;
+				}
+				size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+				if (kernel::isa() != kernel::Isa::scalar)
+					i = detail::intersects_sse2(xs_.data(), ys_.data(), ws_.data(), hs_.data(), size(),
+					                            rect.x, rect.y, rect.x + rect.w, rect.y + rect.h, mask.data());
+#endif
+				for (; i < size(); ++i)
+					mask[i] = (*this)[i].intersects(rect);
+			}
+
+			std::vector<Uint8> intersects(const RectType &rect) const {
+				std::vector<Uint8> mask(size());
+				intersects(rect, mask);
+				return mask;
+			}
+
+			/**
+			 * \brief replaces every rectangle by its intersection with \c rect, as Rect::intersection, so that
+			 * rectangles outside become empty rectangles at the origin
+			 */
+			void clip(const RectType &rect) noexcept {
+				if (rect.empty()) {
+					std::fill(xs_.begin(), xs_.end(), Arithmetic(0));
+					std::fill(ys_.begin(), ys_.end(), Arithmetic(0));
+					std::fill(ws_.begin(), ws_.end(), Arithmetic(0));
+					std::fill(hs_.begin(), hs_.end(), Arithmetic(0));
+					return;
+				}
+				size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+				if (kernel::isa() != kernel::Isa::scalar)
+					i = detail::clip_sse2(xs_.data(), ys_.data(), ws_.data(), hs_.data(), size(),
+					                      rect.x, rect.y, rect.x + rect.w, rect.y + rect.h);
+#endif
+				for (; i < size(); ++i)
+					set(i, (*this)[i].intersection(rect));
+			}
+
+			/**
+			 * \brief the smallest rectangle containing every rectangle, as Rect::united over all of them
+			 * \return the bounds of the rectangles that are not empty, or an empty rectangle if they all are
+			 */
+			RectType bounds() const noexcept {
+				Arithmetic bounds[4] = {std::numeric_limits<Arithmetic>::max(), std::numeric_limits<Arithmetic>::max(),
+				                        std::numeric_limits<Arithmetic>::lowest(), std::numeric_limits<Arithmetic>::lowest()};
+				size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+				if (kernel::isa() != kernel::Isa::scalar)
+					i = detail::bounds_sse2(xs_.data(), ys_.data(), ws_.data(), hs_.data(), size(), bounds);
+#endif
+				for (; i < size(); ++i) {
+					if (ws_[i] <= 0 || hs_[i] <= 0)
+						continue;
+					bounds[0] = std::min(bounds[0], xs_[i]);
+					bounds[1] = std::min(bounds[1], ys_[i]);
+					bounds[2] = std::max(bounds[2], xs_[i] + ws_[i]);
+					bounds[3] = std::max(bounds[3], ys_[i] + hs_[i]);
+				}
+				if (bounds[0] > bounds[2])
+					return {};
+				return RectType(PointType(bounds[0], bounds[1]), PointType(bounds[2], bounds[3]));
+			}
+		};
+
+		using IPointArray = PointArray<int>;
+		using FPointArray = PointArray<float>;
+		using IRectArray = RectArray<int>;
+		using FRectArray = RectArray<float>;
+	}
+}
@@ -0,0 +1,744 @@
+#pragma once
+
+#include "const.h"
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LEAP_KERNEL_X86
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define LEAP_KERNEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define LEAP_KERNEL_TARGET(isa)
+#endif
+#endif
+
+namespace leap {
+	namespace kernel {
+		/*
+		 * Row kernels over 32-bit pixels. Every kernel has a scalar version and, on x86, SSE2 and AVX2 versions
+		 * picked at runtime, which give exactly the same result as the scalar one.
+		 * Kernels dealing with alpha expect it in the top byte, as in ARGB8888 and ABGR8888, and straight color.
+		 * Blending follows SDL_BLENDMODE_BLEND, each channel rounded to nearest:
+		 *   dstRGB = srcRGB * srcA + dstRGB * (1 - srcA)
+		 *   dstA = srcA + dstA * (1 - srcA)
+		 * SDL's blitters divide by 256 instead, so blend is up to 2 off SDL_BlitSurface per channel, and premultiply
+		 * up to 1 off SDL_PremultiplyAlpha, which truncates; test/kernel.cpp checks both bounds.
+		 */
+
+		enum class Isa {
+			scalar,
+			sse2,
+			avx2
+		};
+
+		inline Isa detected_isa() noexcept {
+#ifdef LEAP_KERNEL_X86
+			static const Isa detected = SDL_HasAVX2() ? Isa::avx2 : SDL_HasSSE2() ? Isa::sse2 : Isa::scalar;
+			return detected;
+#else
+			return Isa::scalar;
+#endif
+		}
+
+		namespace detail {
+			inline std::atomic<Isa> &isa_limit() noexcept {
+				static std::atomic<Isa> limit{Isa::avx2};
+				return limit;
+			}
+
+			inline Uint32 div255(Uint32 x) noexcept {
+				x += 128;
+				return (x + (x >> 8)) >> 8;
+			}
+
+			inline Uint32 blend(Uint32 dst, Uint32 src) noexcept {
+				const Uint32 a = src >> 24, ia = 255 - a;
+				Uint32 result = div255((src >> 24) * 255 + (dst >> 24) * ia) << 24;
+				for (int shift = 0; shift < 24; shift += 8)
+					result |= div255(((src >> shift) & 0xff) * a + ((dst >> shift) & 0xff) * ia) << shift;
+				return result;
+			}
+
+			inline Uint32 premultiply(Uint32 pixel) noexcept {
+				const Uint32 a = pixel >> 24;
+				Uint32 result = pixel & 0xff000000;
+				for (int shift = 0; shift < 24; shift += 8)
+					result |= div255(((pixel >> shift) & 0xff) * a) << shift;
+				return result;
+			}
+
+			// 255 / a in 16.16 fixed point, rounded
+			inline const std::array<Uint32, 256> &reciprocals() noexcept {
+				static const std::array<Uint32, 256> table = [] {
+					std::array<Uint32, 256> result{};
+					for (Uint32 a = 1; a < 256; ++a)
+						result[a] = (255u * 65536 + a / 2) / a;
+					return result;
+				}();
+				return table;
+			}
+
+			inline Uint32 unpremultiply(Uint32 pixel, const std::array<Uint32, 256> &table) noexcept {
+				const Uint32 a = pixel >> 24;
+				if (a == 0)
+					return 0;
+				if (a == 255)
+					return pixel;
+				Uint32 result = pixel & 0xff000000;
+				for (int shift = 0; shift < 24; shift += 8)
+					result |= std::min<Uint32>(255, (((pixel >> shift) & 0xff) * table[a] + 32768) >> 16) << shift;
+				return result;
+			}
+
+#ifdef LEAP_KERNEL_X86
+			LEAP_KERNEL_TARGET("sse2")
+			inline __m128i div255_sse2(__m128i x) noexcept {
+				x = _mm_add_epi16(x, _mm_set1_epi16(128));
+				return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+			}
+
+			// the source factor, alpha for color and 255 for alpha, of 2 pixels unpacked to 16 bits
+			LEAP_KERNEL_TARGET("sse2")
+			inline __m128i factor_sse2(__m128i pixels) noexcept {
+				const __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, 0xff), 0xff);
+				return _mm_or_si128(_mm_and_si128(alpha, _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1)),
+				                    _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0));
+			}
+
+			LEAP_KERNEL_TARGET("sse2")
+			inline __m128i blend_half_sse2(__m128i s, __m128i d) noexcept {
+				const __m128i factor = factor_sse2(s);
+				const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255),
+				                                      _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xff), 0xff));
+				return div255_sse2(_mm_add_epi16(_mm_mullo_epi16(s, factor), _mm_mullo_epi16(d, inverse)));
+			}
+
+			LEAP_KERNEL_TARGET("sse2")
+			inline size_t fill_sse2(Uint32 *dst, size_t n, Uint32 value) noexcept {
+				const __m128i v = _mm_set1_epi32(static_cast<int>(value));
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v);
+				return i;
+			}
+
+			LEAP_KERNEL_TARGET("sse2")
+			inline size_t blend_sse2(Uint32 *dst, const Uint32 *src, size_t n) noexcept {
+				const __m128i zero = _mm_setzero_si128();
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+					const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+					const __m128i lo = blend_half_sse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+					const __m128i hi = blend_half_sse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+				}
+				return i;
+			}
+
+			LEAP_KERNEL_TARGET("sse2")
+			inline size_t premultiply_sse2(Uint32 *pixels, size_t n) noexcept {
+				const __m128i zero = _mm_setzero_si128();
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + i));
+					const __m128i lo = _mm_unpacklo_epi8(p, zero), hi = _mm_unpackhi_epi8(p, zero);
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(pixels + i),
+					                 _mm_packus_epi16(div255_sse2(_mm_mullo_epi16(lo, factor_sse2(lo))),
+					                                  div255_sse2(_mm_mullo_epi16(hi, factor_sse2(hi)))));
+				}
+				return i;
+			}
+
+			LEAP_KERNEL_TARGET("sse2")
+			inline size_t swizzle_sse2(Uint32 *dst, const Uint32 *src, size_t n, const std::array<int, 4> &from) noexcept {
+				const __m128i byte = _mm_set1_epi32(0xff);
+				__m128i down[4], up[4];
+				for (int b = 0; b < 4; ++b) {
+					down[b] = _mm_cvtsi32_si128(from[b] * 8);
+					up[b] = _mm_cvtsi32_si128(b * 8);
+				}
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+					__m128i result = _mm_setzero_si128();
+					for (int b = 0; b < 4; ++b)
+						result = _mm_or_si128(result, _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(p, down[b]), byte), up[b]));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), result);
+				}
+				return i;
+			}
+
+			LEAP_KERNEL_TARGET("avx2")
+			inline __m256i div255_avx2(__m256i x) noexcept {
+				x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+				return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+			}
+
+			LEAP_KERNEL_TARGET("avx2")
+			inline __m256i alpha_avx2(__m256i pixels) noexcept {
+				return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, 0xff), 0xff);
+			}
+
+			LEAP_KERNEL_TARGET("avx2")
+			inline __m256i factor_avx2(__m256i pixels) noexcept {
+				const __m256i rgb = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+				const __m256i one = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+				return _mm256_or_si256(_mm256_and_si256(alpha_avx2(pixels), rgb), one);
+			}
+
+			LEAP_KERNEL_TARGET("avx2")
+			inline __m256i blend_half_avx2(__m256i s, __m256i d) noexcept {
+				const __m256i inverse = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha_avx2(s));
+				return div255_avx2(_mm256_add_epi16(_mm256_mullo_epi16(s, factor_avx2(s)), _mm256_mullo_epi16(d, inverse)));
+			}
+
+			LEAP_KERNEL_TARGET("avx2")
+			inline size_t fill_avx2(Uint32 *dst, size_t n, Uint32 value) noexcept {
+				const __m256i v = _mm256_set1_epi32(static_cast<int>(value));
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8)
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), v);
+				return i;
+			}
+
+			LEAP_KERNEL_TARGET("avx2")
+			inline size_t blend_avx2(Uint32 *dst, const Uint32 *src, size_t n) noexcept {
+				const __m256i zero = _mm256_setzero_si256();
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8) {
+					const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+					const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+					const __m256i lo = blend_half_avx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero));
+					const __m256i hi = blend_half_avx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero));
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_packus_epi16(lo, hi));
+				}
+				return i;
+			}
+
+			LEAP_KERNEL_TARGET("avx2")
+			inline size_t premultiply_avx2(Uint32 *pixels, size_t n) noexcept {
+				const __m256i zero = _mm256_setzero_si256();
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8) {
+					const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pixels + i));
+					const __m256i lo = _mm256_unpacklo_epi8(p, zero), hi = _mm256_unpackhi_epi8(p, zero);
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(pixels + i),
+					                    _mm256_packus_epi16(div255_avx2(_mm256_mullo_epi16(lo, factor_avx2(lo))),
+					                                        div255_avx2(_mm256_mullo_epi16(hi, factor_avx2(hi)))));
+				}
+				return i;
+			}
+
+			LEAP_KERNEL_TARGET("avx2")
+			inline size_t swizzle_avx2(Uint32 *dst, const Uint32 *src, size_t n, const std::array<int, 4> &from) noexcept {
+				alignas(32) char order[32];
+				for (int i = 0; i < 32; ++i)
+					order[i] = static_cast<char>(i / 4 * 4 + from[i % 4]);
+				const __m256i mask = _mm256_load_si256(reinterpret_cast<const __m256i *>(order));
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8) {
+					const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_shuffle_epi8(p, mask));
+				}
+				return i;
+			}
+
+			LEAP_KERNEL_TARGET("sse2")
+			inline size_t half_sse2(Uint32 *dst, const Uint32 *row0, const Uint32 *row1, size_t n) noexcept {
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					const __m128i a = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + i * 2)),
+					                               _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + i * 2)));
+					const __m128i b = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + i * 2 + 4)),
+					                               _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + i * 2 + 4)));
+					const __m128 fa = _mm_castsi128_ps(a), fb = _mm_castsi128_ps(b);
+					const __m128i even = _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(2, 0, 2, 0)));
+					const __m128i odd = _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(3, 1, 3, 1)));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_avg_epu8(even, odd));
+				}
+				return i;
+			}
+
+			LEAP_KERNEL_TARGET("sse2")
+			inline size_t bilinear_sse2(Uint32 *dst, const Uint32 *row0, const Uint32 *row1, int fy,
+			                            const int *xs, const int *fxs, size_t n) noexcept {
+				const __m128i zero = _mm_setzero_si128(), round = _mm_set1_epi16(128);
+				const __m128i wy0 = _mm_set1_epi16(static_cast<short>(256 - fy)), wy1 = _mm_set1_epi16(static_cast<short>(fy));
+				size_t i = 0;
+				for (; i < n; ++i) {
+					const int x = xs[i], fx = fxs[i];
+					const __m128i wx = _mm_set_epi16(static_cast<short>(fx), static_cast<short>(fx), static_cast<short>(fx), static_cast<short>(fx),
+					                                 static_cast<short>(256 - fx), static_cast<short>(256 - fx),
+					                                 static_cast<short>(256 - fx), static_cast<short>(256 - fx));
+					const __m128i p0 = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(row0 + x)), zero), wx);
+					const __m128i p1 = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(row1 + x)), zero), wx);
+					const __m128i h0 = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(p0, _mm_srli_si128(p0, 8)), round), 8);
+					const __m128i h1 = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(p1, _mm_srli_si128(p1, 8)), round), 8);
+					const __m128i v = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(h0, wy0), _mm_mullo_epi16(h1, wy1)), round), 8);
+					dst[i] = static_cast<Uint32>(_mm_cvtsi128_si32(_mm_packus_epi16(v, zero)));
+				}
+				return i;
+			}
+
+			LEAP_KERNEL_TARGET("avx2")
+			inline size_t half_avx2(Uint32 *dst, const Uint32 *row0, const Uint32 *row1, size_t n) noexcept {
+				size_t i = 0;
+				for (; i + 8 <= n; i += 8) {
+					const __m256i a = _mm256_avg_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(row0 + i * 2)),
+					                                  _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row1 + i * 2)));
+					const __m256i b = _mm256_avg_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(row0 + i * 2 + 8)),
+					                                  _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row1 + i * 2 + 8)));
+					const __m256 fa = _mm256_castsi256_ps(a), fb = _mm256_castsi256_ps(b);
+					// shuffling works within 128-bit lanes, so the pixels are put back in order afterwards
+					const __m256i even = _mm256_castps_si256(_mm256_shuffle_ps(fa, fb, _MM_SHUFFLE(2, 0, 2, 0)));
+					const __m256i odd = _mm256_castps_si256(_mm256_shuffle_ps(fa, fb, _MM_SHUFFLE(3, 1, 3, 1)));
+					_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+					                    _mm256_permute4x64_epi64(_mm256_avg_epu8(even, odd), _MM_SHUFFLE(3, 1, 2, 0)));
+				}
+				return i;
+			}
+#endif
+		}
+
+		/**
+		 * \brief the instruction set the kernels use, the best one detected unless limited by limit_isa
+		 */
+		inline Isa isa() noexcept {
+			return std::min(detected_isa(), detail::isa_limit().load(std::memory_order_relaxed));
+		}
+
+		/**
+		 * \brief keeps the kernels from using instruction sets above \c limit, to compare or debug them
+		 */
+		inline void limit_isa(Isa limit) noexcept {
+			detail::isa_limit().store(limit, std::memory_order_relaxed);
+		}
+
+		inline void fill(Uint32 *dst, size_t n, Uint32 value) noexcept {
+			size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+			const Isa current = isa();
+			if (current == Isa::avx2)
+				i = detail::fill_avx2(dst, n, value);
+			else if (current == Isa::sse2)
+				i = detail::fill_sse2(dst, n, value);
+#endif
+			std::fill(dst + i, dst + n, value);
+		}
+
+		/**
+		 * \brief blends \c src over \c dst, both with alpha in the top byte
+		 * \details each channel is rounded to nearest, where SDL_BlitSurface divides by 256, so results are up to
+		 * 2 off SDL per channel, and the same as SDL where the source alpha is 0 or 255
+		 */
+		inline void blend(Uint32 *dst, const Uint32 *src, size_t n) noexcept {
+			size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+			const Isa current = isa();
+			if (current == Isa::avx2)
+				i = detail::blend_avx2(dst, src, n);
+			else if (current == Isa::sse2)
+				i = detail::blend_sse2(dst, src, n);
+#endif
+			for (; i < n; ++i)
+				dst[i] = detail::blend(dst[i], src[i]);
+		}
+
+		/**
+		 * \brief multiplies the color of pixels with alpha in the top byte by their alpha
+		 * \details rounded to nearest, where SDL_PremultiplyAlpha truncates, so results are up to 1 off SDL
+		 */
+		inline void premultiply(Uint32 *pixels, size_t n) noexcept {
+			size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+			const Isa current = isa();
+			if (current == Isa::avx2)
+				i = detail::premultiply_avx2(pixels, n);
+			else if (current == Isa::sse2)
+				i = detail::premultiply_sse2(pixels, n);
+#endif
+			for (; i < n; ++i)
+				pixels[i] = detail::premultiply(pixels[i]);
+		}
+
+		/**
+		 * \brief divides the color of premultiplied pixels by their alpha, fully transparent pixels become 0
+		 * \details a division per channel does not vectorize well, so this uses a table of reciprocals on every
+		 * instruction set
+		 */
+		inline void unpremultiply(Uint32 *pixels, size_t n) noexcept {
+			const auto &table = detail::reciprocals();
+			for (size_t i = 0; i < n; ++i)
+				pixels[i] = detail::unpremultiply(pixels[i], table);
+		}
+
+		/**
+		 * \brief the byte of a source pixel each byte of a converted pixel comes from, bytes counted from the lowest
+		 */
+		using Swizzle = std::array<int, 4>;
+
+		/**
+		 * \brief the shifts of the alpha, red, green and blue channels of a 32-bit format with 8 bits per channel
+		 * \return whether the format is one of ARGB8888, RGBA8888, ABGR8888 and BGRA8888
+		 */
+		inline bool channel_shifts(Uint32 format, std::array<int, 4> &shifts) noexcept {
+			switch (format) {
+				case SDL_PIXELFORMAT_ARGB8888:
+					shifts = {24, 16, 8, 0};
+					return true;
+				case SDL_PIXELFORMAT_RGBA8888:
+					shifts = {0, 24, 16, 8};
+					return true;
+				case SDL_PIXELFORMAT_ABGR8888:
+					shifts = {24, 0, 8, 16};
+					return true;
+				case SDL_PIXELFORMAT_BGRA8888:
+					shifts = {0, 8, 16, 24};
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		/**
+		 * \brief the swizzle converting pixels of \c from into pixels of \c to
+		 * \return whether both formats are supported by channel_shifts
+		 */
+		inline bool make_swizzle(Uint32 from, Uint32 to, Swizzle &swizzle) noexcept {
+			std::array<int, 4> source, target;
+			if (!channel_shifts(from, source) || !channel_shifts(to, target))
+				return false;
+			for (int channel = 0; channel < 4; ++channel)
+				swizzle[target[channel] / 8] = source[channel] / 8;
+			return true;
+		}
+
+		inline void swizzle(Uint32 *dst, const Uint32 *src, size_t n, const Swizzle &from) noexcept {
+			size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+			const Isa current = isa();
+			if (current == Isa::avx2)
+				i = detail::swizzle_avx2(dst, src, n, from);
+			else if (current == Isa::sse2)
+				i = detail::swizzle_sse2(dst, src, n, from);
+#endif
+			for (; i < n; ++i) {
+				Uint32 result = 0;
+				for (int b = 0; b < 4; ++b)
+					result |= ((src[i] >> (from[b] * 8)) & 0xff) << (b * 8);
+				dst[i] = result;
+			}
+		}
+
+		/**
+		 * \brief averages 2x2 blocks of two rows into one row of half the width, for any 32-bit format
+		 * \details each channel is rounded as avg(avg(a, c), avg(b, d)), where avg(x, y) = (x + y + 1) / 2
+		 * \param n the number of pixels written, \c row0 and \c row1 must hold twice as many
+		 */
+		inline void half(Uint32 *dst, const Uint32 *row0, const Uint32 *row1, size_t n) noexcept {
+			size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+			const Isa current = isa();
+			if (current == Isa::avx2)
+				i = detail::half_avx2(dst, row0, row1, n);
+			else if (current == Isa::sse2)
+				i = detail::half_sse2(dst, row0, row1, n);
+#endif
+			const auto avg = [](Uint32 x, Uint32 y) {
+				// per byte (x + y + 1) / 2, without carries between bytes
+				return (x | y) - (((x ^ y) >> 1) & 0x7f7f7f7f);
+			};
+			for (; i < n; ++i)
+				dst[i] = avg(avg(row0[i * 2], row1[i * 2]), avg(row0[i * 2 + 1], row1[i * 2 + 1]));
+		}
+
+		/**
+		 * \brief interpolates a row between two rows, for any 32-bit format
+		 * \details weights are in 1/256, each pass rounded: horizontally in each row, then vertically
+		 * \param fy the weight of \c row1
+		 * \param xs for each pixel written, the left one of the two source pixels, the right one must exist
+		 * \param fxs for each pixel written, the weight of the right source pixel
+		 * \param n the number of pixels written
+		 */
+		inline void bilinear(Uint32 *dst, const Uint32 *row0, const Uint32 *row1, int fy,
+		                     const int *xs, const int *fxs, size_t n) noexcept {
+			size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+			if (isa() != Isa::scalar)
+				i = detail::bilinear_sse2(dst, row0, row1, fy, xs, fxs, n);
+#endif
+			for (; i < n; ++i) {
+				const int x = xs[i], fx = fxs[i];
+				Uint32 result = 0;
+				for (int shift = 0; shift < 32; shift += 8) {
+					const auto channel = [shift](Uint32 pixel) {
+						return static_cast<int>((pixel >> shift) & 0xff);
+					};
+					const int h0 = (channel(row0[x]) * (256 - fx) + channel(row0[x + 1]) * fx + 128) >> 8;
+					const int h1 = (channel(row1[x]) * (256 - fx) + channel(row1[x + 1]) * fx + 128) >> 8;
+					result |= static_cast<Uint32>((h0 * (256 - fy) + h1 * fy + 128) >> 8) << shift;
+				}
+				dst[i] = result;
+			}
+		}
+
+		/*
+		 * Color kernels. Channels are rounded as the Color methods they batch, so that both give the same colors.
+		 * Blending in linear light converts through tables of the sRGB transfer function: 16 bits per channel in
+		 * linear light, and 4096 steps back to sRGB, which keeps every sRGB level apart.
+		 */
+
+		enum class Blend {
+			// straight color, blended in sRGB as SDL_BLENDMODE_BLEND
+			straight,
+			// premultiplied color: dst = src + dst * (1 - srcA)
+			premultiplied,
+			// straight color, blended in linear light
+			linear
+		};
+
+		namespace detail {
+			struct SrgbTables {
+				std::array<Uint16, 256> linear;
+				std::array<Uint8, 4096> srgb;
+			};
+
+			inline const SrgbTables &srgb_tables() noexcept {
+				static const SrgbTables tables = [] {
+					SrgbTables result{};
+					for (int i = 0; i < 256; ++i) {
+						const double c = i / 255.0;
+						const double l = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+						result.linear[static_cast<size_t>(i)] = static_cast<Uint16>(std::lround(l * 65535));
+					}
+					for (int i = 0; i < 4096; ++i) {
+						// the center of the step, so that rounding errors of the linear values even out
+						const double l = (i + 0.5) / 4096;
+						const double c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1 / 2.4) - 0.055;
+						result.srgb[static_cast<size_t>(i)] = static_cast<Uint8>(std::lround(std::clamp(c, 0.0, 1.0) * 255));
+					}
+					result.srgb[0] = 0;
+					return result;
+				}();
+				return tables;
+			}
+
+			inline Uint32 blend_premultiplied(Uint32 dst, Uint32 src) noexcept {
+				const Uint32 ia = 255 - (src >> 24);
+				Uint32 result = 0;
+				for (int shift = 0; shift < 32; shift += 8)
+					result |= std::min<Uint32>(255, ((src >> shift) & 0xff) + div255(((dst >> shift) & 0xff) * ia)) << shift;
+				return result;
+			}
+
+			inline Uint32 blend_linear(Uint32 dst, Uint32 src, const SrgbTables &tables) noexcept {
+				const Uint32 a = src >> 24, ia = 255 - a;
+				Uint32 result = div255(a * 255 + (dst >> 24) * ia) << 24;
+				for (int shift = 0; shift < 24; shift += 8) {
+					const Uint32 s = tables.linear[(src >> shift) & 0xff], d = tables.linear[(dst >> shift) & 0xff];
+					const Uint32 l = (s * a + d * ia + 127) / 255;
+					result |= static_cast<Uint32>(tables.srgb[l >> 4]) << shift;
+				}
+				return result;
+			}
+
+			inline Uint32 dim(Uint32 pixel, int value, Uint32 keep) noexcept {
+				Uint32 result = pixel & keep;
+				for (int shift = 0; shift < 32; shift += 8)
+					if (((keep >> shift) & 0xff) == 0)
+						result |= static_cast<Uint32>(std::clamp(static_cast<int>((pixel >> shift) & 0xff) + value, 0, 255)) << shift;
+				return result;
+			}
+
+			// floor((a + b) / 2) of each channel but the alpha, which becomes 0 as in Color::merge_rgb
+			inline Uint32 merge_rgb(Uint32 a, Uint32 b) noexcept {
+				return ((a & b) + (((a ^ b) >> 1) & 0x7f7f7f7f)) & 0x00ffffff;
+			}
+
+			inline Uint32 merge(Uint32 x, Uint32 y) noexcept {
+				const Uint32 a1 = 255 - (x >> 24), a2 = 255 - (y >> 24);
+				Uint32 result = (((x >> 24) + (y >> 24)) >> 1) << 24;
+				for (int shift = 0; shift < 24; shift += 8)
+					result |= ((((x >> shift) & 0xff) * a1 + ((y >> shift) & 0xff) * a2) >> 1) / 255 << shift;
+				return result;
+			}
+
+#ifdef LEAP_KERNEL_X86
+			LEAP_KERNEL_TARGET("sse2")
+			inline __m128i alpha_sse2(__m128i pixels) noexcept {
+				return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, 0xff), 0xff);
+			}
+
+			LEAP_KERNEL_TARGET("sse2")
+			inline size_t blend_premultiplied_sse2(Uint32 *dst, const Uint32 *src, size_t n) noexcept {
+				const __m128i zero = _mm_setzero_si128(), full = _mm_set1_epi16(255);
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+					const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+					const __m128i lo = div255_sse2(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero),
+					                                               _mm_sub_epi16(full, alpha_sse2(_mm_unpacklo_epi8(s, zero)))));
+					const __m128i hi = div255_sse2(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero),
+					                                               _mm_sub_epi16(full, alpha_sse2(_mm_unpackhi_epi8(s, zero)))));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_adds_epu8(s, _mm_packus_epi16(lo, hi)));
+				}
+				return i;
+			}
+
+			LEAP_KERNEL_TARGET("sse2")
+			inline size_t dim_sse2(Uint32 *pixels, size_t n, int value, Uint32 keep) noexcept {
+				const auto step = static_cast<Uint8>(std::min(std::abs(value), 255));
+				const __m128i delta = _mm_andnot_si128(_mm_set1_epi32(static_cast<int>(keep)), _mm_set1_epi8(static_cast<char>(step)));
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + i));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(pixels + i),
+					                 value >= 0 ? _mm_adds_epu8(p, delta) : _mm_subs_epu8(p, delta));
+				}
+				return i;
+			}
+
+			LEAP_KERNEL_TARGET("sse2")
+			inline size_t merge_rgb_sse2(Uint32 *dst, const Uint32 *a, const Uint32 *b, size_t n) noexcept {
+				const __m128i one = _mm_set1_epi8(1), rgb = _mm_set1_epi32(0x00ffffff);
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+					const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+					// _mm_avg_epu8 rounds up, which the odd sums correct back down
+					const __m128i floor = _mm_sub_epi8(_mm_avg_epu8(x, y), _mm_and_si128(_mm_xor_si128(x, y), one));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_and_si128(floor, rgb));
+				}
+				return i;
+			}
+
+			// the 8 channels of 2 pixels in 16 bits, merged as Color::merge
+			LEAP_KERNEL_TARGET("sse2")
+			inline __m128i merge_half_sse2(__m128i x, __m128i y) noexcept {
+				const __m128i full = _mm_set1_epi16(255), one = _mm_set1_epi16(1);
+				const __m128i alpha = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+				const __m128i p1 = _mm_mullo_epi16(x, _mm_sub_epi16(full, alpha_sse2(x)));
+				const __m128i p2 = _mm_mullo_epi16(y, _mm_sub_epi16(full, alpha_sse2(y)));
+				// (p1 + p2) >> 1 without overflowing 16 bits, then an exact division by 255 of values below 2^16
+				const __m128i half = _mm_sub_epi16(_mm_avg_epu16(p1, p2), _mm_and_si128(_mm_xor_si128(p1, p2), one));
+				const __m128i color = _mm_srli_epi16(_mm_mulhi_epu16(half, _mm_set1_epi16(static_cast<short>(0x8081))), 7);
+				const __m128i average = _mm_srli_epi16(_mm_add_epi16(x, y), 1);
+				return _mm_or_si128(_mm_andnot_si128(alpha, color), _mm_and_si128(alpha, average));
+			}
+
+			LEAP_KERNEL_TARGET("sse2")
+			inline size_t merge_sse2(Uint32 *dst, const Uint32 *a, const Uint32 *b, size_t n) noexcept {
+				const __m128i zero = _mm_setzero_si128();
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4) {
+					const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+					const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+					const __m128i lo = merge_half_sse2(_mm_unpacklo_epi8(x, zero), _mm_unpacklo_epi8(y, zero));
+					const __m128i hi = merge_half_sse2(_mm_unpackhi_epi8(x, zero), _mm_unpackhi_epi8(y, zero));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+				}
+				return i;
+			}
+#endif
+		}
+
+		/**
+		 * \brief the value of an sRGB channel in linear light, from 0 to 65535
+		 */
+		inline Uint16 to_linear(Uint8 value) noexcept {
+			return detail::srgb_tables().linear[value];
+		}
+
+		/**
+		 * \brief the sRGB channel nearest to a value in linear light, from 0 to 65535
+		 */
+		inline Uint8 from_linear(Uint16 value) noexcept {
+			return detail::srgb_tables().srgb[value >> 4];
+		}
+
+		/**
+		 * \brief blends premultiplied \c src over premultiplied \c dst, both with alpha in the top byte
+		 * \details channels saturate at 255, in case \c src is not validly premultiplied
+		 */
+		inline void blend_premultiplied(Uint32 *dst, const Uint32 *src, size_t n) noexcept {
+			size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+			if (isa() != Isa::scalar)
+				i = detail::blend_premultiplied_sse2(dst, src, n);
+#endif
+			for (; i < n; ++i)
+				dst[i] = detail::blend_premultiplied(dst[i], src[i]);
+		}
+
+		/**
+		 * \brief blends \c src over \c dst as blend does, but mixing the colors in linear light, which keeps
+		 * gradients and fades from darkening in the middle
+		 * \details the tables are looked up per channel, which SIMD does not speed up, so this is scalar
+		 */
+		inline void blend_linear(Uint32 *dst, const Uint32 *src, size_t n) noexcept {
+			const auto &tables = detail::srgb_tables();
+			for (size_t i = 0; i < n; ++i)
+				dst[i] = detail::blend_linear(dst[i], src[i], tables);
+		}
+
+		inline void blend(Uint32 *dst, const Uint32 *src, size_t n, Blend mode) noexcept {
+			switch (mode) {
+				case Blend::straight:
+					blend(dst, src, n);
+					break;
+				case Blend::premultiplied:
+					blend_premultiplied(dst, src, n);
+					break;
+				case Blend::linear:
+					blend_linear(dst, src, n);
+					break;
+			}
+		}
+
+		/**
+		 * \brief adds \c value to every channel, clamped to 0 ~ 255, as Color::dim
+		 * \param keep the mask of the bytes left alone, such as the alpha
+		 */
+		inline void dim(Uint32 *pixels, size_t n, int value, Uint32 keep) noexcept {
+			size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+			if (isa() != Isa::scalar)
+				i = detail::dim_sse2(pixels, n, value, keep);
+#endif
+			for (; i < n; ++i)
+				pixels[i] = detail::dim(pixels[i], value, keep);
+		}
+
+		/**
+		 * \brief merges pixels with alpha in the top byte as Color::merge_rgb, the alpha of the result is 0
+		 */
+		inline void merge_rgb(Uint32 *dst, const Uint32 *a, const Uint32 *b, size_t n) noexcept {
+			size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+			if (isa() != Isa::scalar)
+				i = detail::merge_rgb_sse2(dst, a, b, n);
+#endif
+			for (; i < n; ++i)
+				dst[i] = detail::merge_rgb(a[i], b[i]);
+		}
+
+		/**
+		 * \brief merges pixels with alpha in the top byte as Color::merge
+		 */
+		inline void merge(Uint32 *dst, const Uint32 *a, const Uint32 *b, size_t n) noexcept {
+			size_t i = 0;
+#ifdef LEAP_KERNEL_X86
+			if (isa() != Isa::scalar)
+				i = detail::merge_sse2(dst, a, b, n);
+#endif
+			for (; i < n; ++i)
+				dst[i] = detail::merge(a[i], b[i]);
+		}
+	}
+}
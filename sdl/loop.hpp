@@ -0,0 +1,134 @@
+#pragma once
+
+#include "const.h"
+#include "except.hpp"
+#include "event.hpp"
+#include <queue>
+#include <limits>
+#include <vector>
+#include <functional>
+
+namespace leap::event {
+	struct LoopStats {
+		// frames run, and times the loop blocked waiting for a reason to run one
+		size_t frames, waits;
+	};
+
+	/**
+	 * \brief A run loop that sleeps in SDL_WaitEventTimeout until there is something to do.
+	 * \details A frame runs when an event arrives, when a deadline set by wake_at passes, or after
+	 * request_redraw. Otherwise the loop blocks in SDL, which returns as soon as an event is queued, so waiting
+	 * adds no input latency. Animations keep running by asking for a redraw or a wakeup from every frame.
+	 */
+	class Loop {
+		Pump &pump_;
+		std::priority_queue<Uint64, std::vector<Uint64>, std::greater<>> deadlines_;
+		Uint32 wake_type_;
+		bool redraw_ = true, running_ = false;
+		LoopStats stats_{};
+
+		bool ready() const noexcept {
+			return redraw_ || !pump_.empty();
+		}
+
+		// blocks until an event arrives or the earliest deadline passes
+		void wait() {
+			if (ready())
+				return;
+			++stats_.waits;
+			SDL_Event event;
+			while (true) {
+				int received;
+				if (deadlines_.empty())
+					received = SDL_WaitEvent(&event);
+				else {
+					const Uint64 now = SDL_GetTicks64();
+					if (deadlines_.top() <= now)
+						return;
+					const Uint64 left = deadlines_.top() - now;
+					received = SDL_WaitEventTimeout(&event, static_cast<int>(std::min<Uint64>(left, std::numeric_limits<int>::max())));
+				}
+				if (received) {
+					pump_.add(event);
+					return;
+				}
+				// a timeout that came early is waited again, an infinite wait returning nothing is an error
+				if (deadlines_.empty())
+					except::throw_exc();
+			}
+		}
+
+	public:
+		/**
+		 * \param pump the pump the events are dispatched by, which must outlive the loop
+		 * \throw LeapException if SDL has no user event left for wake
+		 */
+		explicit Loop(Pump &pump) : pump_(pump), wake_type_(SDL_RegisterEvents(1)) {
+			if (wake_type_ == static_cast<Uint32>(-1))
+				throw except::LeapException("no user event left for the loop");
+			pump_.on(wake_type_, [](const SDL_Event &) {});
+		}
+
+		Loop(const Loop &) = delete;
+
+		/**
+		 * \brief runs the next frame without waiting
+		 */
+		void request_redraw() noexcept {
+			redraw_ = true;
+		}
+
+		/**
+		 * \brief runs a frame once SDL_GetTicks64() reaches \c ticks, in milliseconds
+		 */
+		void wake_at(Uint64 ticks) {
+			deadlines_.push(ticks);
+		}
+
+		void wake_in(Uint32 ms) {
+			wake_at(SDL_GetTicks64() + ms);
+		}
+
+		/**
+		 * \brief wakes the loop from any thread, through an event pushed to SDL
+		 */
+		void wake() const {
+			SDL_Event event{};
+			event.type = wake_type_;
+			if (SDL_PushEvent(&event) < 0)
+				except::throw_exc();
+		}
+
+		/**
+		 * \brief makes run return after the current frame, or after the events being dispatched
+		 */
+		void stop() noexcept {
+			running_ = false;
+		}
+
+		/**
+		 * \brief calls \c frame whenever there is something to do, until stop
+		 * \param frame updates and draws, the events of the frame are dispatched to the pump before
+		 */
+		template <typename Function>
+		void run(Function &&frame) {
+			running_ = true;
+			while (running_) {
+				wait();
+				pump_.pump();
+				if (!running_)
+					break;
+				const Uint64 now = SDL_GetTicks64();
+				while (!deadlines_.empty() && deadlines_.top() <= now)
+					deadlines_.pop();
+				redraw_ = false;
+				++stats_.frames;
+				frame();
+			}
+		}
+
+		LoopStats stats() const noexcept {
+			return stats_;
+		}
+	};
+}
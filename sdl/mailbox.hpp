@@ -0,0 +1,222 @@
+#pragma once
+
+#include "const.h"
+#include "except.hpp"
+#include "event.hpp"
+#include <new>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cstddef>
+
+namespace leap::event {
+	/**
+	 * \brief A bounded lock-free queue of messages from any threads to the thread running the event loop.
+	 * \details Messages live in a ring of slots allocated once, so posting constructs the message in place and
+	 * never allocates. Each slot carries a sequence number telling whether it is free or filled, so producers
+	 * only contend on one counter, and the consumer takes messages without any atomic read-modify-write.
+	 * The first message posted after a drain pushes one SDL user event, which wakes SDL_WaitEvent and tells
+	 * the event loop to drain, so SDL_PushEvent and its lock are not paid per message.
+	 * \tparam T the message type, which should not allocate on construction for posting to stay allocation-free
+	 */
+	template <typename T>
+	class Mailbox {
+		struct Slot {
+			std::atomic<size_t> sequence;
+			// false when the constructor of the message threw, the slot is then skipped
+			bool valid;
+			alignas(T) std::byte storage[sizeof(T)];
+
+			T *get() noexcept {
+				return std::launder(reinterpret_cast<T *>(storage));
+			}
+		};
+
+		// the producer and consumer counters sit on separate cache lines, so they do not slow each other down
+		static constexpr size_t line = 64;
+
+		std::unique_ptr<Slot[]> slots_;
+		size_t mask_;
+		Uint32 type_;
+		alignas(line) std::atomic<size_t> tail_{0};
+		alignas(line) std::atomic<bool> notified_{false};
+		std::atomic<size_t> dropped_{0};
+		alignas(line) size_t head_ = 0;
+
+		void notify() noexcept {
+			if (notified_.exchange(true, std::memory_order_acq_rel))
+				return;
+			SDL_Event event{};
+			event.type = type_;
+			// without the event, the next post tries again
+			if (SDL_PushEvent(&event) < 0)
+				notified_.store(false, std::memory_order_release);
+		}
+
+		// the oldest filled slot, or nullptr
+		Slot *front() noexcept {
+			Slot &slot = slots_[head_ & mask_];
+			return slot.sequence.load(std::memory_order_acquire) == head_ + 1 ? &slot : nullptr;
+		}
+
+		// destroys the message of the front slot and hands the slot back to the producers
+		void pop(Slot &slot) noexcept {
+			if (slot.valid)
+				slot.get()->~T();
+			slot.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+			++head_;
+		}
+
+	public:
+		/**
+		 * \param capacity the most messages waiting at once, rounded up to a power of 2
+		 * \throw LeapException if SDL has no user event left
+		 */
+		explicit Mailbox(size_t capacity = 1024) {
+			size_t size = 2;
+			while (size < capacity)
+				size *= 2;
+			slots_ = std::make_unique<Slot[]>(size);
+			for (size_t i = 0; i < size; ++i)
+				slots_[i].sequence.store(i, std::memory_order_relaxed);
+			mask_ = size - 1;
+			type_ = SDL_RegisterEvents(1);
+			if (type_ == static_cast<Uint32>(-1))
+				throw except::LeapException("no user event left for the mailbox");
+		}
+
+		Mailbox(const Mailbox &) = delete;
+
+		~Mailbox() {
+			while (Slot *slot = front())
+				pop(*slot);
+		}
+
+		/**
+		 * \brief the type of the SDL events that announce messages
+		 */
+		Uint32 event_type() const noexcept {
+			return type_;
+		}
+
+		/**
+		 * \brief whether \c event is an announcement of this mailbox
+		 */
+		bool announces(const Event &event) const noexcept {
+			return (*event).type == type_;
+		}
+
+		/**
+		 * \brief constructs a message from \c args in a free slot, from any thread
+		 * \return whether there was a free slot, the message is dropped otherwise
+		 */
+		template <typename... Types>
+		bool post(Types &&... args) {
+			size_t position = tail_.load(std::memory_order_relaxed);
+			Slot *slot;
+			while (true) {
+				slot = &slots_[position & mask_];
+				const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+				const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+				if (difference == 0) {
+					if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (difference < 0) {
+					dropped_.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				else
+					position = tail_.load(std::memory_order_relaxed);
+			}
+			try {
+				new (slot->storage) T(std::forward<Types>(args)...);
+				slot->valid = true;
+			}
+			catch (...) {
+				// the slot is taken, so it is still published rather than left to block the consumer
+				slot->valid = false;
+				slot->sequence.store(position + 1, std::memory_order_release);
+				throw;
+			}
+			slot->sequence.store(position + 1, std::memory_order_release);
+			notify();
+			return true;
+		}
+
+		/**
+		 * \brief takes the oldest message, on the consumer thread only
+		 * \return whether there was one
+		 */
+		bool receive(T &message) {
+			while (Slot *slot = front()) {
+				const bool valid = slot->valid;
+				if (valid)
+					message = std::move(*slot->get());
+				pop(*slot);
+				if (valid)
+					return true;
+			}
+			return false;
+		}
+
+		/**
+		 * \brief calls \c function(message) for every message waiting, on the consumer thread only
+		 * \details The messages are handed over where they are stored, without being moved out.
+		 * \return the number of messages taken
+		 */
+		template <typename Function>
+		size_t drain(Function &&function) {
+			// cleared first, so that a message posted during the drain announces itself again
+			notified_.exchange(false, std::memory_order_acq_rel);
+			size_t count = 0;
+			while (Slot *slot = front()) {
+				// the slot is freed even if the function throws
+				struct Pop {
+					Mailbox &mailbox;
+					Slot &slot;
+
+					~Pop() {
+						mailbox.pop(slot);
+					}
+				} guard{*this, *slot};
+				if (slot->valid) {
+					function(*slot->get());
+					++count;
+				}
+			}
+			return count;
+		}
+
+		/**
+		 * \brief drains the mailbox into \c handler whenever \c pump dispatches its announcement
+		 * \param pump the pump of the consumer thread, the mailbox must outlive its handlers
+		 */
+		template <typename Function>
+		void attach(Pump &pump, Function handler) {
+			pump.on(type_, [this, handler = std::move(handler)](const SDL_Event &) mutable {
+				drain(handler);
+			});
+		}
+
+		/**
+		 * \brief the number of messages dropped for a full mailbox since the start
+		 */
+		size_t dropped() const noexcept {
+			return dropped_.load(std::memory_order_relaxed);
+		}
+	};
+
+	template <typename T>
+	using MailboxPtr = std::shared_ptr<Mailbox<T>>;
+
+	template <typename T, typename... Types>
+	MailboxPtr<T> make_mailbox(Types &&... args) {
+		return std::make_shared<Mailbox<T>>(std::forward<Types>(args)...);
+	}
+}
+
+namespace leap::pointer {
+	using event::MailboxPtr;
+	using event::make_mailbox;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "const.h"
+#include "except.hpp"
+#include <span>
+#include <string>
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace leap {
+	namespace mapped {
+		/**
+		 * \brief A whole file mapped read-only into memory.
+		 */
+		class MappedFile {
+			const std::byte *data_ = nullptr;
+			size_t size_ = 0;
+
+			void release() noexcept {
+				if (data_ == nullptr)
+					return;
+#ifdef _WIN32
+				UnmapViewOfFile(data_);
+#else
+				munmap(const_cast<std::byte *>(data_), size_);
+#endif
+				data_ = nullptr;
+				size_ = 0;
+			}
+
+		public:
+			/**
+			 * \brief an empty mapping, to be assigned later
+			 */
+			MappedFile() noexcept = default;
+
+			/**
+			 * \param path the file to map, which must not be modified while it is mapped
+			 * \throw LeapException if the file cannot be opened or mapped
+			 */
+			explicit MappedFile(const std::string &path) {
+				const auto fail = [&path] {
+					throw except::LeapException("cannot map " + path);
+				};
+#ifdef _WIN32
+				HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+				                          FILE_ATTRIBUTE_NORMAL, nullptr);
+				if (file == INVALID_HANDLE_VALUE)
+					fail();
+				LARGE_INTEGER size;
+				if (!GetFileSizeEx(file, &size)) {
+					CloseHandle(file);
+					fail();
+				}
+				size_ = static_cast<size_t>(size.QuadPart);
+				if (size_ != 0) {
+					HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+					if (mapping != nullptr) {
+						data_ = static_cast<const std::byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+						CloseHandle(mapping);
+					}
+				}
+				CloseHandle(file);
+#else
+				const int file = open(path.c_str(), O_RDONLY);
+				if (file < 0)
+					fail();
+				struct stat status;
+				if (fstat(file, &status)) {
+					close(file);
+					fail();
+				}
+				size_ = static_cast<size_t>(status.st_size);
+				if (size_ != 0) {
+					void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+					data_ = data == MAP_FAILED ? nullptr : static_cast<const std::byte *>(data);
+				}
+				close(file);
+#endif
+				if (size_ != 0 && data_ == nullptr)
+					fail();
+			}
+
+			MappedFile(MappedFile &&other) noexcept : data_(other.data_), size_(other.size_) {
+				other.data_ = nullptr;
+				other.size_ = 0;
+			}
+
+			MappedFile &operator=(MappedFile &&other) noexcept {
+				if (this != &other) {
+					release();
+					std::swap(data_, other.data_);
+					std::swap(size_, other.size_);
+				}
+				return *this;
+			}
+
+			MappedFile(const MappedFile &) = delete;
+
+			~MappedFile() noexcept {
+				release();
+			}
+
+			const std::byte *data() const noexcept {
+				return data_;
+			}
+
+			size_t size() const noexcept {
+				return size_;
+			}
+
+			std::span<const std::byte> bytes() const noexcept {
+				return {data_, size_};
+			}
+		};
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "const.h"
+#include "except.hpp"
+#include "position.hpp"
+#include "render.hpp"
+#include "texture.hpp"
+#include "surface.hpp"
+#include "pointer.hpp"
+#include <memory>
+#include <vector>
+
+namespace leap {
+	namespace mipmap {
+		/**
+		 * \brief makes the mip chain of a surface: the surface itself, then each level half the size of the
+		 * one before by Surface::half, down to 1x1
+		 * \details premultiply the surface first, so that transparent pixels do not darken their neighbours
+		 */
+		inline std::vector<pointer::SurfacePtr> make_mip_chain(const pointer::SurfacePtr &surface) {
+			std::vector<pointer::SurfacePtr> chain{surface};
+			while (chain.back()->get()->w > 1 || chain.back()->get()->h > 1)
+				chain.push_back(pointer::make_surface(chain.back()->half()));
+			return chain;
+		}
+
+		/**
+		 * \brief A texture kept as a mip chain, which draws with the smallest level that covers the destination.
+		 * \details Levels are uploaded when first drawn, so only the pixels that are sampled reach the renderer.
+		 * SDL samples one level, so a destination between two levels shrinks the larger by less than half.
+		 */
+		class MipTexture {
+			const render::Renderer &renderer_;
+			std::vector<pointer::SurfacePtr> chain_;
+			std::vector<pointer::TexturePtr> textures_;
+			SDL_BlendMode blend_mode_;
+
+		public:
+			/**
+			 * \param renderer the renderer the levels are uploaded to, which must outlive the texture
+			 * \param chain the mip chain, as made by make_mip_chain
+			 * \param blend_mode the blend mode of the textures, SDL_BLENDMODE_BLEND suits straight alpha and
+			 * a custom mode of SDL_ComposeCustomBlendMode premultiplied alpha
+			 */
+			MipTexture(const render::Renderer &renderer, std::vector<pointer::SurfacePtr> chain,
+			           SDL_BlendMode blend_mode = SDL_BLENDMODE_BLEND) :
+				renderer_(renderer), chain_(std::move(chain)), textures_(chain_.size()), blend_mode_(blend_mode) {
+				if (chain_.empty())
+					throw except::LeapException("a mip texture needs at least one level");
+			}
+
+			/**
+			 * \brief makes the mip chain of \c surface
+			 */
+			MipTexture(const render::Renderer &renderer, const pointer::SurfacePtr &surface,
+			           SDL_BlendMode blend_mode = SDL_BLENDMODE_BLEND) :
+				MipTexture(renderer, make_mip_chain(surface), blend_mode) {}
+
+			MipTexture(const MipTexture &) = delete;
+
+			size_t levels() const noexcept {
+				return chain_.size();
+			}
+
+			pos::IPoint level_size(size_t level) const noexcept {
+				return chain_[level]->get_size();
+			}
+
+			/**
+			 * \brief the smallest level at least as large as \c size on both sides, or level 0
+			 */
+			size_t level_for(const pos::IPoint &size) const noexcept {
+				size_t level = 0;
+				while (level + 1 < chain_.size()) {
+					const auto next = level_size(level + 1);
+					if (next.x < size.x || next.y < size.y)
+						break;
+					++level;
+				}
+				return level;
+			}
+
+			/**
+			 * \brief the texture of a level, uploaded on first use
+			 */
+			const pointer::TexturePtr &texture(size_t level) {
+				auto &texture = textures_[level];
+				if (!texture) {
+					texture = pointer::make_texture(renderer_.convert(*chain_[level]));
+					texture->set_blend_mode(blend_mode_);
+				}
+				return texture;
+			}
+
+			const pointer::TexturePtr &texture_for(const pos::IPoint &size) {
+				return texture(level_for(size));
+			}
+
+			/**
+			 * \brief frees the textures uploaded, for example after the renderer lost them
+			 */
+			void release() noexcept {
+				for (auto &texture : textures_)
+					texture.reset();
+			}
+
+			void copy_to(const pos::IRect &dst) {
+				texture_for(dst.size())->copy_to(renderer_, dst);
+			}
+		};
+
+		using MipTexturePtr = std::shared_ptr<MipTexture>;
+
+		template <typename... Types>
+		MipTexturePtr make_mip_texture(Types &&... args) {
+			return std::make_shared<MipTexture>(std::forward<Types>(args)...);
+		}
+	}
+
+	namespace pointer {
+		using mipmap::MipTexturePtr;
+		using mipmap::make_mip_texture;
+	}
+}
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "const.h"
+#include "except.hpp"
+#include "mapped.hpp"
+#include <span>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <string_view>
+
+namespace leap {
+	namespace pack {
+		static_assert(SDL_BYTEORDER == SDL_LIL_ENDIAN, "asset packs are stored little-endian");
+
+		/*
+		 * Layout of a pack, every number little-endian:
+		 *   Header
+		 *   Entry[count], sorted by name
+		 *   the names, not terminated
+		 *   the data of each entry, starting at a multiple of alignment
+		 */
+		struct Header {
+			char magic[8];
+			Uint32 version;
+			Uint32 count;
+		};
+
+		struct Entry {
+			Uint64 offset, size;
+			Uint32 name_offset, name_size;
+		};
+
+		static_assert(sizeof(Header) == 16 && sizeof(Entry) == 24, "pack layout must not be padded");
+
+		constexpr char magic[8] = {'L', 'E', 'A', 'P', 'P', 'A', 'C', 'K'};
+		constexpr Uint32 version = 1;
+		// data is aligned to a cache line, so it can be read in place by anything
+		constexpr size_t alignment = 64;
+
+		/**
+		 * \brief A read-only archive of assets, mapped into memory and read without copying.
+		 */
+		class Pack {
+			mapped::MappedFile file_;
+			const Entry *entries_ = nullptr;
+			size_t count_ = 0;
+
+			std::string_view name_of(const Entry &entry) const noexcept {
+				return {reinterpret_cast<const char *>(file_.data()) + entry.name_offset, entry.name_size};
+			}
+
+			const Entry *find_entry(std::string_view name) const noexcept {
+				const Entry *end = entries_ + count_;
+				const Entry *it = std::lower_bound(entries_, end, name, [this](const Entry &entry, std::string_view key) {
+					return name_of(entry) < key;
+				});
+				return it != end && name_of(*it) == name ? it : nullptr;
+			}
+
+		public:
+			/**
+			 * \param path the pack file, built by the leap-pack tool or PackWriter
+			 * \throw LeapException if the file cannot be mapped or is not a valid pack
+			 */
+			explicit Pack(const std::string &path) : file_(path) {
+				const auto fail = [&path] {
+					throw except::LeapException("invalid asset pack " + path);
+				};
+				const size_t size = file_.size();
+				if (size < sizeof(Header))
+					fail();
+				Header header;
+				std::memcpy(&header, file_.data(), sizeof(Header));
+				if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version)
+					fail();
+				count_ = header.count;
+				if (count_ > (size - sizeof(Header)) / sizeof(Entry))
+					fail();
+				entries_ = reinterpret_cast<const Entry *>(file_.data() + sizeof(Header));
+				for (size_t i = 0; i < count_; ++i) {
+					const Entry &entry = entries_[i];
+					if (entry.offset > size || entry.size > size - entry.offset ||
+					    entry.name_offset > size || entry.name_size > size - entry.name_offset ||
+					    (i > 0 && !(name_of(entries_[i - 1]) < name_of(entry))))
+						fail();
+				}
+			}
+
+			Pack(const Pack &) = delete;
+
+			bool contains(std::string_view name) const noexcept {
+				return find_entry(name) != nullptr;
+			}
+
+			/**
+			 * \return the data of an entry, which stays valid as long as the pack
+			 * \throw LeapException if there is no entry of the name
+			 */
+			std::span<const std::byte> at(std::string_view name) const {
+				const Entry *entry = find_entry(name);
+				if (entry == nullptr)
+					throw except::LeapException("no asset " + std::string(name) + " in the pack");
+				return {file_.data() + entry->offset, static_cast<size_t>(entry->size)};
+			}
+
+			/**
+			 * \brief opens an entry as a read-only stream over the mapped data
+			 * \return the stream, for the \c _RW functions of SDL and its libraries, which must not outlive the pack
+			 */
+			SDL_RWops *open(std::string_view name) const {
+				const auto data = at(name);
+				SDL_RWops *rw = SDL_RWFromConstMem(data.data(), static_cast<int>(data.size()));
+				if (rw == nullptr)
+					except::throw_exc();
+				return rw;
+			}
+
+			size_t size() const noexcept {
+				return count_;
+			}
+
+			/**
+			 * \return the name of the entry at \c index, entries are sorted by name
+			 */
+			std::string_view name(size_t index) const {
+				if (index >= count_)
+					throw std::out_of_range("pack entry index out of range");
+				return name_of(entries_[index]);
+			}
+		};
+
+		/**
+		 * \brief Builds a pack file from named blobs.
+		 */
+		class PackWriter {
+			std::vector<std::pair<std::string, std::vector<std::byte>>> entries_;
+
+		public:
+			void add(std::string name, std::span<const std::byte> data) {
+				entries_.emplace_back(std::move(name), std::vector<std::byte>(data.begin(), data.end()));
+			}
+
+			/**
+			 * \brief adds the content of a file
+			 * \throw LeapException if the file cannot be read
+			 */
+			void add_file(std::string name, const std::string &path) {
+				std::ifstream file(path, std::ios::binary);
+				if (!file)
+					throw except::LeapException("cannot read " + path);
+				std::vector<char> data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+				add(std::move(name), std::as_bytes(std::span<const char>(data)));
+			}
+
+			size_t size() const noexcept {
+				return entries_.size();
+			}
+
+			/**
+			 * \brief writes every entry added into a pack file
+			 * \throw LeapException if two entries have the same name or the file cannot be written
+			 */
+			void write(const std::string &path) {
+				std::sort(entries_.begin(), entries_.end(), [](const auto &lhs, const auto &rhs) {
+					return lhs.first < rhs.first;
+				});
+				for (size_t i = 1; i < entries_.size(); ++i)
+					if (entries_[i - 1].first == entries_[i].first)
+						throw except::LeapException("duplicate asset " + entries_[i].first);
+
+				const auto align = [](size_t offset) {
+					return (offset + alignment - 1) / alignment * alignment;
+				};
+				Header header{};
+				std::memcpy(header.magic, magic, sizeof(magic));
+				header.version = version;
+				header.count = static_cast<Uint32>(entries_.size());
+
+				std::vector<Entry> index(entries_.size());
+				size_t offset = sizeof(Header) + sizeof(Entry) * entries_.size();
+				for (size_t i = 0; i < entries_.size(); ++i) {
+					index[i].name_offset = static_cast<Uint32>(offset);
+					index[i].name_size = static_cast<Uint32>(entries_[i].first.size());
+					offset += entries_[i].first.size();
+				}
+				for (size_t i = 0; i < entries_.size(); ++i) {
+					offset = align(offset);
+					index[i].offset = offset;
+					index[i].size = entries_[i].second.size();
+					offset += entries_[i].second.size();
+				}
+
+				std::ofstream file(path, std::ios::binary | std::ios::trunc);
+				if (!file)
+					throw except::LeapException("cannot write " + path);
+				file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+				file.write(reinterpret_cast<const char *>(index.data()),
+				           static_cast<std::streamsize>(sizeof(Entry) * index.size()));
+				size_t written = sizeof(Header) + sizeof(Entry) * index.size();
+				for (const auto &entry : entries_) {
+					file.write(entry.first.data(), static_cast<std::streamsize>(entry.first.size()));
+					written += entry.first.size();
+				}
+				for (size_t i = 0; i < entries_.size(); ++i) {
+					static constexpr char padding[alignment] = {};
+					file.write(padding, static_cast<std::streamsize>(index[i].offset - written));
+					file.write(reinterpret_cast<const char *>(entries_[i].second.data()),
+					           static_cast<std::streamsize>(entries_[i].second.size()));
+					written = index[i].offset + index[i].size;
+				}
+				if (!file.flush())
+					throw except::LeapException("cannot write " + path);
+			}
+		};
+
+		using PackPtr = std::shared_ptr<Pack>;
+
+		template <typename... Types>
+		PackPtr make_pack(Types &&... args) {
+			return std::make_shared<Pack>(std::forward<Types>(args)...);
+		}
+	}
+
+	namespace pointer {
+		using pack::PackPtr;
+		using pack::make_pack;
+	}
+}
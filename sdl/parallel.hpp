@@ -0,0 +1,197 @@
+#pragma once
+
+#include "const.h"
+#include "except.hpp"
+#include "position.hpp"
+#include "surface.hpp"
+#include "kernel.hpp"
+#include "worker.hpp"
+#include <vector>
+#include <future>
+#include <cstring>
+#include <algorithm>
+
+namespace leap {
+	namespace parallel {
+		/*
+		 * Surface operations split into bands of rows, each about tile_bytes of destination pixels so that a
+		 * band stays in the cache of one core, run on a worker pool. The calling thread runs a band too and
+		 * waits for the rest, so these must not be called from a job of the same pool.
+		 * Formats and modes the kernels do not cover fall back to SDL on the calling thread.
+		 */
+
+		constexpr size_t tile_bytes = 256 << 10;
+
+		/**
+		 * \brief runs \c function(y_begin, y_end) over bands of the rows of \c area
+		 * \param row_bytes the number of bytes a row of \c area covers
+		 */
+		template <typename Function>
+		void for_bands(worker::WorkerPool &pool, const pos::IRect &area, size_t row_bytes, Function &&function) {
+			if (area.empty())
+				return;
+			const int rows = static_cast<int>(std::max<size_t>(1, tile_bytes / std::max<size_t>(1, row_bytes)));
+			std::vector<std::future<void>> bands;
+			int y = area.y;
+			for (; y + rows < area.y + area.h; y += rows)
+				bands.push_back(pool.submit([&function, y, rows] { function(y, y + rows); }));
+			// the last band is run here instead of waiting idle
+			std::exception_ptr error;
+			try {
+				function(y, area.y + area.h);
+			}
+			catch (...) {
+				error = std::current_exception();
+			}
+			for (auto &band : bands) {
+				try {
+					band.get();
+				}
+				catch (...) {
+					if (!error)
+						error = std::current_exception();
+				}
+			}
+			if (error)
+				std::rethrow_exception(error);
+		}
+
+		inline pos::IRect clip_of(const surface::Surface &surface) noexcept {
+			const SDL_Rect &clip = surface->clip_rect;
+			return {clip.x, clip.y, clip.w, clip.h};
+		}
+
+		/**
+		 * \brief fills a rectangle with an opaque color, the same as Surface::fill
+		 */
+		inline void fill(worker::WorkerPool &pool, const surface::Surface &surface, const SDL_Color &color,
+		                 const pos::IRect &rect) {
+			if (surface->format->BytesPerPixel != 4) {
+				surface.fill(color, rect);
+				return;
+			}
+			surface.detach();
+			const Uint32 value = surface.map_rgb(color);
+			const auto area = rect.intersection(clip_of(surface));
+			surface.locked([&] {
+				for_bands(pool, area, static_cast<size_t>(area.w) * 4, [&](int begin, int end) {
+					for (int y = begin; y < end; ++y)
+						kernel::fill(surface.row(y) + area.x, static_cast<size_t>(area.w), value);
+				});
+			});
+		}
+
+		inline void fill(worker::WorkerPool &pool, const surface::Surface &surface, const SDL_Color &color) {
+			fill(pool, surface, color, surface.get_range());
+		}
+
+		/**
+		 * \brief whether the kernels draw \c src the way SDL_BlitSurface does, up to the rounding of kernel::blend:
+		 * with SDL_BLENDMODE_NONE or SDL_BLENDMODE_BLEND, no color key and no alpha or color modulation
+		 */
+		inline bool plain_blit(const surface::Surface &src, SDL_BlendMode &mode) noexcept {
+			Uint8 alpha, r, g, b;
+			return SDL_GetSurfaceBlendMode(src.get(), &mode) == 0 &&
+			       (mode == SDL_BLENDMODE_NONE || mode == SDL_BLENDMODE_BLEND) && !SDL_HasColorKey(src.get()) &&
+			       SDL_GetSurfaceAlphaMod(src.get(), &alpha) == 0 && alpha == 255 &&
+			       SDL_GetSurfaceColorMod(src.get(), &r, &g, &b) == 0 && r == 255 && g == 255 && b == 255;
+		}
+
+		/**
+		 * \brief draws \c src onto \c dst at \c point, the same as Surface::blit
+		 * \details surfaces of the same format among ARGB8888 and ABGR8888 are copied with SDL_BLENDMODE_NONE
+		 * and blended by kernel::blend with SDL_BLENDMODE_BLEND, other surfaces, blend modes, color keys and
+		 * modulations are blitted by SDL on this thread
+		 */
+		inline void blit(worker::WorkerPool &pool, const surface::Surface &dst, const surface::Surface &src,
+		                 const pos::IPoint &point) {
+			SDL_BlendMode mode;
+			if (src->format->format != dst->format->format || !dst.has_top_alpha() || !plain_blit(src, mode)) {
+				dst.blit(src, point);
+				return;
+			}
+			dst.detach();
+			const auto area = (src.get_range() + point).intersection(clip_of(dst));
+			src.locked([&] {
+				dst.locked([&] {
+					for_bands(pool, area, static_cast<size_t>(area.w) * 4, [&](int begin, int end) {
+						for (int y = begin; y < end; ++y) {
+							Uint32 *target = dst.row(y) + area.x;
+							const Uint32 *source = src.row(y - point.y) + (area.x - point.x);
+							if (mode == SDL_BLENDMODE_NONE)
+								std::memcpy(target, source, static_cast<size_t>(area.w) * 4);
+							else
+								kernel::blend(target, source, static_cast<size_t>(area.w));
+						}
+					});
+				});
+			});
+		}
+
+		/**
+		 * \brief stretches the whole of \c src over the whole of \c dst, taking the nearest pixel
+		 * \details the pixels of \c dst are replaced, whatever the blend mode, color key and modulation of \c src,
+		 * as SDL_SoftStretch does. Surfaces of another format are converted to the format of \c dst first, and
+		 * surfaces not of 32 bits are stretched by SDL_SoftStretch on this thread
+		 */
+		inline void scale(worker::WorkerPool &pool, const surface::Surface &dst, const surface::Surface &src) {
+			dst.detach();
+			if (src->format->format != dst->format->format) {
+				SDL_Surface *converted = SDL_ConvertSurface(src.get(), dst->format, 0);
+				if (converted == nullptr)
+					except::throw_exc();
+				scale(pool, dst, surface::Surface(converted));
+				return;
+			}
+			if (dst->format->BytesPerPixel != 4) {
+				SDL_Rect target{0, 0, dst->w, dst->h};
+				if (SDL_SoftStretch(src.get(), nullptr, dst.get(), &target))
+					except::throw_exc();
+				return;
+			}
+			const int sw = src->w, sh = src->h, dw = dst->w, dh = dst->h;
+			std::vector<int> columns(static_cast<size_t>(dw));
+			for (int x = 0; x < dw; ++x)
+				columns[static_cast<size_t>(x)] = static_cast<int>((static_cast<long long>(x) * 2 + 1) * sw / (2LL * dw));
+			src.locked([&] {
+				dst.locked([&] {
+					for_bands(pool, dst.get_range(), static_cast<size_t>(dw) * 4, [&](int begin, int end) {
+						for (int y = begin; y < end; ++y) {
+							const Uint32 *source = src.row(static_cast<int>((static_cast<long long>(y) * 2 + 1) * sh / (2LL * dh)));
+							Uint32 *target = dst.row(y);
+							for (int x = 0; x < dw; ++x)
+								target[x] = source[columns[static_cast<size_t>(x)]];
+						}
+					});
+				});
+			});
+		}
+
+		/**
+		 * \brief copies a surface into a new surface of another format, the same as Surface::convert
+		 * \return the new surface, owned by the caller
+		 */
+		inline SDL_Surface *convert(worker::WorkerPool &pool, const surface::Surface &surface, Uint32 format) {
+			kernel::Swizzle swizzle;
+			if (!kernel::make_swizzle(surface->format->format, format, swizzle))
+				return surface.convert(format);
+			SDL_Surface *converted = SDL_CreateRGBSurfaceWithFormat(0, surface->w, surface->h, 32, format);
+			if (converted == nullptr)
+				except::throw_exc();
+			try {
+				surface.locked([&] {
+					for_bands(pool, surface.get_range(), static_cast<size_t>(surface->w) * 4, [&](int begin, int end) {
+						for (int y = begin; y < end; ++y)
+							kernel::swizzle(reinterpret_cast<Uint32 *>(static_cast<Uint8 *>(converted->pixels) + static_cast<size_t>(y) * converted->pitch),
+							                surface.row(y), static_cast<size_t>(surface->w), swizzle);
+					});
+				});
+			}
+			catch (...) {
+				SDL_FreeSurface(converted);
+				throw;
+			}
+			return converted;
+		}
+	}
+}
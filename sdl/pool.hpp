@@ -0,0 +1,166 @@
+#pragma once
+
+#include "const.h"
+#include "except.hpp"
+#include "position.hpp"
+#include "surface.hpp"
+#include "pointer.hpp"
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+namespace leap {
+	namespace pool {
+		struct PoolStats {
+			size_t hits, misses;
+			// bytes of pixel buffers held, in use or idle, now and at most
+			size_t bytes, peak_bytes;
+			size_t idle_bytes;
+		};
+
+		/**
+		 * \brief Recycles pixel buffers of surfaces of the same size and format.
+		 * \details Surfaces are made with SDL_CreateRGBSurfaceWithFormatFrom over a pooled buffer, which goes
+		 * back to the pool when the last SurfacePtr to the surface drops, from any thread. The pool may be
+		 * destroyed before its surfaces, whose buffers are then freed instead. Surfaces from the pool forbid
+		 * CopyMode::shared, since a shared SDL_Surface would outlive its buffer, and must not be moved out of
+		 * their SurfacePtr for the same reason.
+		 */
+		class SurfacePool {
+			using Key = std::tuple<int, int, Uint32>;
+			using Buffer = std::unique_ptr<std::byte[]>;
+
+			struct State {
+				std::mutex mutex;
+				std::map<Key, std::vector<Buffer>> idle;
+				size_t max_idle_bytes;
+				PoolStats stats{};
+
+				void release(const Key &key, Buffer buffer, size_t bytes) {
+					std::lock_guard lock(mutex);
+					if (stats.idle_bytes + bytes > max_idle_bytes) {
+						stats.bytes -= bytes;
+						return;
+					}
+					idle[key].push_back(std::move(buffer));
+					stats.idle_bytes += bytes;
+				}
+			};
+
+			std::shared_ptr<State> state_;
+
+			// rows start at 16 bytes, so that the kernels load whole vectors
+			static int pitch_of(int w, Uint32 format) noexcept {
+				return (w * SDL_BYTESPERPIXEL(format) + 15) / 16 * 16;
+			}
+
+		public:
+			/**
+			 * \param max_idle_bytes the most bytes of idle buffers kept, more are freed when released
+			 */
+			explicit SurfacePool(size_t max_idle_bytes = 64 << 20) : state_(std::make_shared<State>()) {
+				state_->max_idle_bytes = max_idle_bytes;
+			}
+
+			SurfacePool(const SurfacePool &) = delete;
+
+			/**
+			 * \brief makes a surface over a recycled buffer, or a new one if none of its size and format is idle
+			 * \details the pixels are not cleared
+			 * \param size the size of the surface
+			 * \param format the pixel format, one of the \c SDL_PixelFormatEnum values with at least 8 bits per pixel
+			 */
+			pointer::SurfacePtr acquire(const pos::IPoint &size, Uint32 format = SDL_PIXELFORMAT_ARGB8888) {
+				const Key key{size.x, size.y, format};
+				const int pitch = pitch_of(size.x, format);
+				const size_t bytes = static_cast<size_t>(pitch) * size.y;
+				Buffer buffer;
+				{
+					std::lock_guard lock(state_->mutex);
+					auto &stats = state_->stats;
+					const auto it = state_->idle.find(key);
+					if (it != state_->idle.end() && !it->second.empty()) {
+						buffer = std::move(it->second.back());
+						it->second.pop_back();
+						stats.idle_bytes -= bytes;
+						++stats.hits;
+					}
+					else {
+						++stats.misses;
+						stats.bytes += bytes;
+						stats.peak_bytes = std::max(stats.peak_bytes, stats.bytes);
+					}
+				}
+				if (!buffer)
+					buffer = std::make_unique<std::byte[]>(bytes);
+
+				SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom(buffer.get(), size.x, size.y,
+				                                                           SDL_BITSPERPIXEL(format), pitch, format);
+				if (surface == nullptr) {
+					state_->release(key, std::move(buffer), bytes);
+					except::throw_exc();
+				}
+				auto pooled = std::make_unique<surface::Surface>(surface);
+				pooled->forbid_sharing();
+				std::weak_ptr<State> owner = state_;
+				std::byte *pixels = buffer.release();
+				return pointer::SurfacePtr(pooled.release(), [owner, key, pixels, bytes](surface::Surface *surface) {
+					// only a reference taken on the SDL_Surface outside of Surface can still share it, and then
+					// the buffer is left to it rather than reused under it
+					const bool shared = surface->is_shared();
+					delete surface;
+					if (shared) {
+						if (const auto state = owner.lock()) {
+							std::lock_guard lock(state->mutex);
+							state->stats.bytes -= bytes;
+						}
+						return;
+					}
+					Buffer buffer(pixels);
+					if (const auto state = owner.lock())
+						state->release(key, std::move(buffer), bytes);
+				});
+			}
+
+			pointer::SurfacePtr acquire(int w, int h, Uint32 format = SDL_PIXELFORMAT_ARGB8888) {
+				return acquire(pos::IPoint(w, h), format);
+			}
+
+			/**
+			 * \brief frees every idle buffer
+			 */
+			void trim() {
+				std::lock_guard lock(state_->mutex);
+				state_->stats.bytes -= state_->stats.idle_bytes;
+				state_->stats.idle_bytes = 0;
+				state_->idle.clear();
+			}
+
+			PoolStats stats() const {
+				std::lock_guard lock(state_->mutex);
+				return state_->stats;
+			}
+
+			void reset_stats() {
+				std::lock_guard lock(state_->mutex);
+				state_->stats.hits = state_->stats.misses = 0;
+				state_->stats.peak_bytes = state_->stats.bytes;
+			}
+		};
+
+		using SurfacePoolPtr = std::shared_ptr<SurfacePool>;
+
+		template <typename... Types>
+		SurfacePoolPtr make_surface_pool(Types &&... args) {
+			return std::make_shared<SurfacePool>(std::forward<Types>(args)...);
+		}
+	}
+
+	namespace pointer {
+		using pool::SurfacePoolPtr;
+		using pool::make_surface_pool;
+	}
+}
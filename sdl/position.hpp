@@ -1,6 +1,7 @@
 #pragma once
 
 #include "const.h"
+#include <algorithm>
 
 namespace leap {
 	namespace pos {
@@ -264,6 +265,55 @@ namespace leap {
 			}
 
 
+			bool empty() const noexcept {
+				return this->w <= 0 || this->h <= 0;
+			}
+
+			Arithmetic area() const noexcept {
+				return empty() ? 0 : this->w * this->h;
+			}
+
+			/**
+			 * \brief checks whether the two rectangles share any area, touching edges do not count
+			 * \param rect the other rectangle
+			 * \return whether the intersection of the rectangles is not empty
+			 */
+			bool intersects(const Rect &rect) const noexcept {
+				return !empty() && !rect.empty() &&
+					this->x < rect.x + rect.w && rect.x < this->x + this->w &&
+					this->y < rect.y + rect.h && rect.y < this->y + this->h;
+			}
+
+			/**
+			 * \brief returns the area shared by the two rectangles
+			 * \param rect the other rectangle
+			 * \return the intersection, or an empty rectangle at the origin if there is none
+			 */
+			Rect intersection(const Rect &rect) const noexcept {
+				if (!intersects(rect))
+					return Rect();
+				const Arithmetic left = std::max(this->x, rect.x), top = std::max(this->y, rect.y);
+				return Rect(left, top,
+				            std::min(this->x + this->w, rect.x + rect.w) - left,
+				            std::min(this->y + this->h, rect.y + rect.h) - top);
+			}
+
+			/**
+			 * \brief returns the smallest rectangle containing both rectangles
+			 * \param rect the other rectangle, empty rectangles are ignored
+			 * \return the bounding rectangle of the two
+			 */
+			Rect united(const Rect &rect) const noexcept {
+				if (rect.empty())
+					return *this;
+				if (empty())
+					return rect;
+				const Arithmetic left = std::min(this->x, rect.x), top = std::min(this->y, rect.y);
+				return Rect(left, top,
+				            std::max(this->x + this->w, rect.x + rect.w) - left,
+				            std::max(this->y + this->h, rect.y + rect.h) - top);
+			}
+
 			bool contains(const Point &point) const noexcept {
 				return this->x <= point.x && point.x <= this->x + this->w && this->y <= point.y &&
 					point.y <= this->y + this->h;
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "const.h"
+#include "position.hpp"
+#include "render.hpp"
+#include <vector>
+#include <span>
+
+namespace leap {
+	namespace primitive {
+		/**
+		 * \brief An immediate-mode accumulator of points, lines and rectangles.
+		 * \details Consecutive primitives of the same kind and color are merged into one bulk submission,
+		 * and connected line segments are merged into one polyline. The draw order is kept as submitted.
+		 */
+		class PrimitiveBatch {
+			enum class Kind {
+				points,
+				lines,
+				rects,
+				filled_rects
+			};
+
+			struct Run {
+				Kind kind;
+				SDL_Color color;
+				size_t begin, count;
+			};
+
+			std::vector<Run> runs_;
+			std::vector<pos::FPoint> points_;
+			std::vector<pos::FRect> rects_;
+
+			size_t submissions_ = 0;
+
+			static bool same_color(const SDL_Color &lhs, const SDL_Color &rhs) noexcept {
+				return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b && lhs.a == rhs.a;
+			}
+
+			/**
+			 * \brief returns the last run if it can take one more primitive, otherwise opens a new run
+			 */
+			Run &run(Kind kind, const SDL_Color &color, size_t begin) {
+				if (runs_.empty() || runs_.back().kind != kind || !same_color(runs_.back().color, color))
+					runs_.push_back(Run{kind, color, begin, 0});
+				return runs_.back();
+			}
+
+			static pos::FPoint to_float(const pos::IPoint &point) noexcept {
+				return {static_cast<float>(point.x), static_cast<float>(point.y)};
+			}
+
+			static pos::FRect to_float(const pos::IRect &rect) noexcept {
+				return {
+					static_cast<float>(rect.x), static_cast<float>(rect.y),
+					static_cast<float>(rect.w), static_cast<float>(rect.h)
+				};
+			}
+
+		public:
+			PrimitiveBatch() = default;
+
+			PrimitiveBatch(const PrimitiveBatch &) = delete;
+
+			void point(const pos::FPoint &point, const SDL_Color &color) {
+				++run(Kind::points, color, points_.size()).count;
+				points_.push_back(point);
+			}
+
+			void point(const pos::IPoint &point, const SDL_Color &color) {
+				this->point(to_float(point), color);
+			}
+
+			/**
+			 * \brief adds a line segment, which joins the previous polyline if it starts where that one ends
+			 */
+			void line(const pos::FPoint &from, const pos::FPoint &to, const SDL_Color &color) {
+				const bool joined = !runs_.empty() && runs_.back().kind == Kind::lines &&
+					same_color(runs_.back().color, color) &&
+					points_.back().x == from.x && points_.back().y == from.y;
+				if (joined) {
+					++runs_.back().count;
+					points_.push_back(to);
+				}
+				else {
+					runs_.push_back(Run{Kind::lines, color, points_.size(), 2});
+					points_.push_back(from);
+					points_.push_back(to);
+				}
+			}
+
+			void line(const pos::IPoint &from, const pos::IPoint &to, const SDL_Color &color) {
+				line(to_float(from), to_float(to), color);
+			}
+
+			void rect(const pos::FRect &rect, const SDL_Color &color) {
+				++run(Kind::rects, color, rects_.size()).count;
+				rects_.push_back(rect);
+			}
+
+			void rect(const pos::IRect &rect, const SDL_Color &color) {
+				this->rect(to_float(rect), color);
+			}
+
+			void fill_rect(const pos::FRect &rect, const SDL_Color &color) {
+				++run(Kind::filled_rects, color, rects_.size()).count;
+				rects_.push_back(rect);
+			}
+
+			void fill_rect(const pos::IRect &rect, const SDL_Color &color) {
+				fill_rect(to_float(rect), color);
+			}
+
+			/**
+			 * \brief submits every accumulated primitive and empties the batch
+			 * \details the draw color of the renderer is left as the color of the last run
+			 * \param renderer the renderer to draw with
+			 */
+			void flush(const render::Renderer &renderer) {
+				submissions_ = 0;
+				for (const auto &run : runs_) {
+					renderer.set_color(run.color);
+					switch (run.kind) {
+					case Kind::points:
+						renderer.draw_points(std::span<const pos::FPoint>(points_.data() + run.begin, run.count));
+						break;
+					case Kind::lines:
+						renderer.draw_lines(std::span<const pos::FPoint>(points_.data() + run.begin, run.count));
+						break;
+					case Kind::rects:
+						renderer.draw_rects(std::span<const pos::FRect>(rects_.data() + run.begin, run.count));
+						break;
+					case Kind::filled_rects:
+						renderer.fill_rects(std::span<const pos::FRect>(rects_.data() + run.begin, run.count));
+						break;
+					}
+					++submissions_;
+				}
+				clear();
+			}
+
+			/**
+			 * \brief drops every accumulated primitive without drawing
+			 */
+			void clear() noexcept {
+				runs_.clear();
+				points_.clear();
+				rects_.clear();
+			}
+
+			bool empty() const noexcept {
+				return runs_.empty();
+			}
+
+			/**
+			 * \brief the number of bulk draw calls issued by the last flush
+			 */
+			size_t submissions() const noexcept {
+				return submissions_;
+			}
+		};
+	}
+}
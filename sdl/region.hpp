@@ -0,0 +1,328 @@
+#pragma once
+
+#include "const.h"
+#include "position.hpp"
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+namespace leap {
+	namespace pos {
+		/**
+		 * \brief A set of pixels, kept as disjoint rectangles in y-x bands.
+		 * \details The rectangles are sorted by y, then x. Rectangles of the same rows form a band, bands do not
+		 * overlap, and the rectangles of a band are sorted and do not touch. Vertically adjacent bands of the same
+		 * spans are merged, so every set has one representation and regions compare by their rectangles.
+		 * Unlike Rect::contains, a region covers the pixels of its rectangles only, the right and bottom edges
+		 * are outside, as for Rect::intersects.
+		 */
+		class Region {
+			std::vector<IRect> rects_;
+			IRect bounds_;
+
+			static constexpr int far = std::numeric_limits<int>::max();
+
+			// the end of the band starting at rects[begin]
+			static size_t band_end(const std::vector<IRect> &rects, size_t begin) noexcept {
+				size_t end = begin + 1;
+				while (end < rects.size() && rects[end].y == rects[begin].y)
+					++end;
+				return end;
+			}
+
+			/**
+			 * \brief combines the spans of two bands over the rows y0 to y1, keeping the pixels where
+			 * \c keep(in_a, in_b) holds, and appends the result to \c out as a band
+			 */
+			template <typename Keep>
+			static void combine(const IRect *a, const IRect *a_end, const IRect *b, const IRect *b_end,
+			                    int y0, int y1, std::vector<IRect> &out, Keep keep) {
+				bool in_a = false, in_b = false, inside = false;
+				int start = 0;
+				while (a != a_end || b != b_end) {
+					const int next_a = a == a_end ? far : in_a ? a->x + a->w : a->x;
+					const int next_b = b == b_end ? far : in_b ? b->x + b->w : b->x;
+					const int x = std::min(next_a, next_b);
+					// every edge at x is passed before deciding, so that touching spans stay one
+					while (a != a_end && (in_a ? a->x + a->w : a->x) == x) {
+						in_a = !in_a;
+						if (!in_a)
+							++a;
+					}
+					while (b != b_end && (in_b ? b->x + b->w : b->x) == x) {
+						in_b = !in_b;
+						if (!in_b)
+							++b;
+					}
+					const bool now = keep(in_a, in_b);
+					if (now && !inside)
+						start = x;
+					else if (!now && inside)
+						out.emplace_back(start, y0, x - start, y1 - y0);
+					inside = now;
+				}
+			}
+
+			/**
+			 * \brief sweeps the bands of two regions from top to bottom, combining the spans of each run of rows
+			 */
+			template <typename Keep>
+			static Region operate(const Region &lhs, const Region &rhs, Keep keep) {
+				const auto &a = lhs.rects_, &b = rhs.rects_;
+				Region result;
+				auto &out = result.rects_;
+				out.reserve(std::max(a.size(), b.size()));
+				size_t ia = 0, ib = 0;
+				size_t ia_end = a.empty() ? 0 : band_end(a, 0), ib_end = b.empty() ? 0 : band_end(b, 0);
+				// where the last band appended starts, to merge it with the next one if they match
+				size_t previous = 0, previous_end = 0;
+				int y = std::numeric_limits<int>::min();
+				while (ia < a.size() || ib < b.size()) {
+					if (ia < a.size() && a[ia].y + a[ia].h <= y) {
+						ia = ia_end;
+						ia_end = ia < a.size() ? band_end(a, ia) : ia;
+						continue;
+					}
+					if (ib < b.size() && b[ib].y + b[ib].h <= y) {
+						ib = ib_end;
+						ib_end = ib < b.size() ? band_end(b, ib) : ib;
+						continue;
+					}
+					const int a_top = ia < a.size() ? a[ia].y : far, b_top = ib < b.size() ? b[ib].y : far;
+					y = std::max(y, std::min(a_top, b_top));
+					const bool a_on = a_top <= y, b_on = b_top <= y;
+					const int y1 = std::min(a_on ? a[ia].y + a[ia].h : a_top, b_on ? b[ib].y + b[ib].h : b_top);
+
+					const size_t begin = out.size();
+					combine(a_on ? &a[ia] : nullptr, a_on ? &a[0] + ia_end : nullptr,
+					        b_on ? &b[ib] : nullptr, b_on ? &b[0] + ib_end : nullptr, y, y1, out, keep);
+					if (out.size() != begin) {
+						const bool same = previous_end == begin && begin - previous == out.size() - begin &&
+						                  out[previous].y + out[previous].h == y &&
+						                  std::equal(out.begin() + static_cast<long>(previous), out.begin() + static_cast<long>(begin),
+						                             out.begin() + static_cast<long>(begin), [](const IRect &l, const IRect &r) {
+							                             return l.x == r.x && l.w == r.w;
+						                             });
+						if (same) {
+							for (size_t i = previous; i < begin; ++i)
+								out[i].h = y1 - out[i].y;
+							out.resize(begin);
+						}
+						else {
+							previous = begin;
+							previous_end = out.size();
+						}
+					}
+					y = y1;
+				}
+				result.update_bounds();
+				return result;
+			}
+
+			void update_bounds() noexcept {
+				if (rects_.empty()) {
+					bounds_ = IRect();
+					return;
+				}
+				int left = rects_.front().x, right = rects_.front().x + rects_.front().w;
+				for (const auto &rect : rects_) {
+					left = std::min(left, rect.x);
+					right = std::max(right, rect.x + rect.w);
+				}
+				const int top = rects_.front().y, bottom = rects_.back().y + rects_.back().h;
+				bounds_ = IRect(left, top, right - left, bottom - top);
+			}
+
+			// unites the regions of rects[begin, end) by halves, which costs about n log n instead of n^2
+			static Region unite(const std::vector<IRect> &rects, size_t begin, size_t end) {
+				if (end - begin == 1)
+					return Region(rects[begin]);
+				const size_t middle = begin + (end - begin) / 2;
+				return unite(rects, begin, middle).united(unite(rects, middle, end));
+			}
+
+		public:
+			Region() = default;
+
+			/**
+			 * \param rect the rectangle covered, an empty rectangle makes an empty region
+			 */
+			explicit Region(const IRect &rect) {
+				if (rect.empty())
+					return;
+				rects_.push_back(rect);
+				bounds_ = rect;
+			}
+
+			/**
+			 * \brief the union of many rectangles
+			 */
+			explicit Region(const std::vector<IRect> &rects) {
+				if (!rects.empty())
+					*this = unite(rects, 0, rects.size());
+			}
+
+			bool operator==(const Region &region) const noexcept {
+				return rects_.size() == region.rects_.size() &&
+				       std::equal(rects_.begin(), rects_.end(), region.rects_.begin(), [](const IRect &l, const IRect &r) {
+					       return l.x == r.x && l.y == r.y && l.w == r.w && l.h == r.h;
+				       });
+			}
+
+			bool operator!=(const Region &region) const noexcept {
+				return !(*this == region);
+			}
+
+			Region united(const Region &region) const {
+				return operate(*this, region, [](bool a, bool b) { return a || b; });
+			}
+
+			Region intersection(const Region &region) const {
+				if (!bounds_.intersects(region.bounds_))
+					return {};
+				return operate(*this, region, [](bool a, bool b) { return a && b; });
+			}
+
+			Region subtracted(const Region &region) const {
+				if (!bounds_.intersects(region.bounds_))
+					return *this;
+				return operate(*this, region, [](bool a, bool b) { return a && !b; });
+			}
+
+			/**
+			 * \brief the pixels in exactly one of the two regions
+			 */
+			Region exclusive(const Region &region) const {
+				return operate(*this, region, [](bool a, bool b) { return a != b; });
+			}
+
+			Region operator|(const Region &region) const {
+				return united(region);
+			}
+
+			Region operator&(const Region &region) const {
+				return intersection(region);
+			}
+
+			Region operator-(const Region &region) const {
+				return subtracted(region);
+			}
+
+			Region operator^(const Region &region) const {
+				return exclusive(region);
+			}
+
+			Region &operator|=(const Region &region) {
+				return *this = united(region);
+			}
+
+			Region &operator&=(const Region &region) {
+				return *this = intersection(region);
+			}
+
+			Region &operator-=(const Region &region) {
+				return *this = subtracted(region);
+			}
+
+			Region &operator^=(const Region &region) {
+				return *this = exclusive(region);
+			}
+
+			Region operator+(const IPoint &offset) const {
+				Region result = *this;
+				result += offset;
+				return result;
+			}
+
+			Region &operator+=(const IPoint &offset) noexcept {
+				for (auto &rect : rects_)
+					rect += offset;
+				if (!rects_.empty())
+					bounds_ += offset;
+				return *this;
+			}
+
+			bool empty() const noexcept {
+				return rects_.empty();
+			}
+
+			void clear() noexcept {
+				rects_.clear();
+				bounds_ = IRect();
+			}
+
+			/**
+			 * \brief the smallest rectangle containing the region, or an empty rectangle
+			 */
+			const IRect &bounds() const noexcept {
+				return bounds_;
+			}
+
+			/**
+			 * \brief the disjoint rectangles of the region, in y-x order
+			 */
+			const std::vector<IRect> &rects() const noexcept {
+				return rects_;
+			}
+
+			std::vector<IRect>::const_iterator begin() const noexcept {
+				return rects_.begin();
+			}
+
+			std::vector<IRect>::const_iterator end() const noexcept {
+				return rects_.end();
+			}
+
+			size_t size() const noexcept {
+				return rects_.size();
+			}
+
+			long long area() const noexcept {
+				long long result = 0;
+				for (const auto &rect : rects_)
+					result += static_cast<long long>(rect.w) * rect.h;
+				return result;
+			}
+
+			/**
+			 * \brief whether the pixel at \c point is in the region
+			 */
+			bool contains(const IPoint &point) const noexcept {
+				// the first rectangle below the point, then back over the band the point may be in
+				auto it = std::upper_bound(rects_.begin(), rects_.end(), point.y, [](int y, const IRect &rect) {
+					return y < rect.y;
+				});
+				while (it != rects_.begin()) {
+					--it;
+					if (it->y + it->h <= point.y)
+						return false;
+					if (it->x <= point.x)
+						return point.x < it->x + it->w;
+				}
+				return false;
+			}
+
+			/**
+			 * \brief whether the region shares any pixel with \c rect
+			 */
+			bool intersects(const IRect &rect) const noexcept {
+				if (!bounds_.intersects(rect))
+					return false;
+				for (const auto &own : rects_) {
+					if (own.y >= rect.y + rect.h)
+						break;
+					if (own.intersects(rect))
+						return true;
+				}
+				return false;
+			}
+
+			/**
+			 * \brief whether every pixel of \c rect is in the region
+			 */
+			bool covers(const IRect &rect) const {
+				return !rect.empty() && (Region(rect) - *this).empty();
+			}
+		};
+	}
+}
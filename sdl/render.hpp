@@ -3,11 +3,20 @@
 #include "const.h"
 #include "position.hpp"
 #include "except.hpp"
+#include <span>
+#include <vector>
 
 namespace leap {
 	namespace render {
 		using pos::IPoint;
 		using pos::IRect;
+		using pos::FPoint;
+		using pos::FRect;
+
+		static_assert(sizeof(IPoint) == sizeof(SDL_Point) && sizeof(FPoint) == sizeof(SDL_FPoint),
+		              "points must be layout compatible with SDL for bulk drawing");
+		static_assert(sizeof(IRect) == sizeof(SDL_Rect) && sizeof(FRect) == sizeof(SDL_FRect),
+		              "rectangles must be layout compatible with SDL for bulk drawing");
 
 		class Window {
 			SDL_Window *window_;
@@ -34,8 +43,82 @@ namespace leap {
 			}
 		};
 
+		/**
+		 * \brief counters of the state changes requested from a Renderer
+		 */
+		struct StateStats {
+			// calls that reached SDL
+			size_t issued = 0;
+			// calls dropped because the state was already set
+			size_t skipped = 0;
+		};
+
 		class Renderer {
+			/**
+			 * \brief the shadow copy of the render state, a \c known flag of \c false means it must be re-issued
+			 */
+			struct State {
+				bool color_known = false, blend_known = false, clip_known = false, viewport_known = false,
+				     target_known = false;
+				SDL_Color color{};
+				SDL_BlendMode blend = SDL_BLENDMODE_NONE;
+				bool clipped = false;
+				SDL_Rect clip{}, viewport{};
+				bool full_viewport = false;
+				SDL_Texture *target = nullptr;
+			};
+
 			SDL_Renderer *renderer_;
+			mutable State state_;
+			mutable StateStats stats_;
+			mutable IPoint offset_{0, 0};
+			// shifted copies of bulk drawing arguments, kept to avoid allocating on every call
+			mutable std::vector<IPoint> points_;
+			mutable std::vector<FPoint> fpoints_;
+			mutable std::vector<IRect> rects_;
+			mutable std::vector<FRect> frects_;
+			mutable std::vector<SDL_Vertex> vertices_;
+
+			bool shifted() const noexcept {
+				return offset_.x != 0 || offset_.y != 0;
+			}
+
+			/**
+			 * \brief the rectangle moved by the offset, or \c rect itself when there is no offset
+			 */
+			const SDL_Rect *shift(const SDL_Rect *rect, SDL_Rect &moved) const noexcept {
+				if (rect == nullptr || !shifted())
+					return rect;
+				moved = {rect->x + offset_.x, rect->y + offset_.y, rect->w, rect->h};
+				return &moved;
+			}
+
+			/**
+			 * \brief the points or rectangles moved by the offset, copied to \c scratch when there is one
+			 */
+			template <typename Type>
+			std::span<const Type> shift(std::span<const Type> items, std::vector<Type> &scratch) const {
+				if (!shifted())
+					return items;
+				scratch.assign(items.begin(), items.end());
+				for (auto &item : scratch) {
+					item.x += offset_.x;
+					item.y += offset_.y;
+				}
+				return scratch;
+			}
+
+			static bool same_rect(const SDL_Rect &lhs, const SDL_Rect &rhs) noexcept {
+				return lhs.x == rhs.x && lhs.y == rhs.y && lhs.w == rhs.w && lhs.h == rhs.h;
+			}
+
+			bool skip(bool unchanged) const noexcept {
+				if (unchanged)
+					++stats_.skipped;
+				else
+					++stats_.issued;
+				return unchanged;
+			}
 
 		public:
 			Renderer(const Window &window, int index, Uint32 flags) noexcept {
@@ -62,16 +145,183 @@ namespace leap {
 				except::throw_exc();
 			}
 
+			/**
+			 * \brief creates an empty texture
+			 * \param format one of the \c SDL_PixelFormatEnum values
+			 * \param access one of the \c SDL_TextureAccess values
+			 * \param w the width of the texture
+			 * \param h the height of the texture
+			 * \return the texture created
+			 */
+			SDL_Texture *create_texture(Uint32 format, int access, int w, int h) const {
+				auto result = SDL_CreateTexture(renderer_, format, access, w, h);
+				if (result)
+					return result;
+				except::throw_exc();
+			}
+
+			SDL_Texture *create_texture(Uint32 format, int access, const IPoint &size) const {
+				return create_texture(format, access, size.x, size.y);
+			}
+
 			void set_color(Uint8 r, Uint8 g, Uint8 b, Uint8 a) const {
+				const SDL_Color &c = state_.color;
+				if (skip(state_.color_known && c.r == r && c.g == g && c.b == b && c.a == a))
+					return;
+				state_.color_known = false;
 				if (SDL_SetRenderDrawColor(renderer_, r, g, b, a))
 					except::throw_exc();
+				state_.color = {r, g, b, a};
+				state_.color_known = true;
 			}
 
 			void set_color(const SDL_Color &color) const noexcept {
 				set_color(color.r, color.g, color.b, color.a);
 			}
 
+			void set_blend_mode(SDL_BlendMode mode) const {
+				if (skip(state_.blend_known && state_.blend == mode))
+					return;
+				state_.blend_known = false;
+				if (SDL_SetRenderDrawBlendMode(renderer_, mode))
+					except::throw_exc();
+				state_.blend = mode;
+				state_.blend_known = true;
+			}
+
+			/**
+			 * \brief sets the clip rectangle of the current target
+			 * \param rect the clip rectangle, moved by the offset, or \c nullptr to disable clipping
+			 */
+			void set_clip(const SDL_Rect *rect) const {
+				SDL_Rect moved;
+				rect = shift(rect, moved);
+				const bool clipped = rect != nullptr;
+				if (skip(state_.clip_known && state_.clipped == clipped && (!clipped || same_rect(state_.clip, *rect))))
+					return;
+				state_.clip_known = false;
+				if (SDL_RenderSetClipRect(renderer_, rect))
+					except::throw_exc();
+				state_.clipped = clipped;
+				if (clipped)
+					state_.clip = *rect;
+				state_.clip_known = true;
+			}
+
+			void set_clip(const IRect &rect) const {
+				set_clip(static_cast<const SDL_Rect *>(&rect));
+			}
+
+			void reset_clip() const {
+				set_clip(nullptr);
+			}
+
+			/**
+			 * \brief sets the drawing area of the current target
+			 * \details the viewport is not moved by the offset. Some backends, such as Direct3D 9, cannot place it at
+			 * negative coordinates, so drawing in other coordinates than the target's is done with set_offset instead
+			 * \param rect the viewport, or \c nullptr for the whole target
+			 */
+			void set_viewport(const SDL_Rect *rect) const {
+				const bool full = rect == nullptr;
+				if (skip(state_.viewport_known && state_.full_viewport == full && (full || same_rect(state_.viewport, *rect))))
+					return;
+				state_.viewport_known = false;
+				if (SDL_RenderSetViewport(renderer_, rect))
+					except::throw_exc();
+				state_.full_viewport = full;
+				if (!full)
+					state_.viewport = *rect;
+				state_.viewport_known = true;
+			}
+
+			void set_viewport(const IRect &rect) const {
+				set_viewport(static_cast<const SDL_Rect *>(&rect));
+			}
+
+			void reset_viewport() const {
+				set_viewport(nullptr);
+			}
+
+			/**
+			 * \brief redirects drawing to a texture created with \c SDL_TEXTUREACCESS_TARGET
+			 * \details SDL keeps a viewport and clip rectangle per target, so their shadow copies are dropped on a switch.
+			 * Only a switch to the window is skipped: a texture destroyed while it is the target resets the target
+			 * to the window, and a new texture may then get the same address
+			 * \param texture the target texture, or \c nullptr for the window
+			 */
+			void set_target(SDL_Texture *texture) const {
+				if (skip(texture == nullptr && state_.target_known && state_.target == nullptr))
+					return;
+				state_.target_known = state_.clip_known = state_.viewport_known = false;
+				if (SDL_SetRenderTarget(renderer_, texture))
+					except::throw_exc();
+				state_.target = texture;
+				state_.target_known = true;
+			}
+
+			void reset_target() const {
+				set_target(nullptr);
+			}
+
+			SDL_Texture *get_target() const noexcept {
+				return SDL_GetRenderTarget(renderer_);
+			}
+
+			/**
+			 * \brief moves everything drawn afterwards, clip rectangles included, by \c offset pixels of the target
+			 * \details the offset is kept by the Renderer rather than SDL, so it holds across targets
+			 */
+			void set_offset(const IPoint &offset) const noexcept {
+				offset_ = offset;
+			}
+
+			const IPoint &get_offset() const noexcept {
+				return offset_;
+			}
+
+			/**
+			 * \brief reads the clip rectangle of the current target
+			 * \param rect where to store the clip rectangle
+			 * \return whether clipping is enabled
+			 */
+			bool get_clip(SDL_Rect &rect) const noexcept {
+				SDL_RenderGetClipRect(renderer_, &rect);
+				// in the coordinates set_clip takes
+				rect.x -= offset_.x;
+				rect.y -= offset_.y;
+				return SDL_RenderIsClipEnabled(renderer_);
+			}
+
+			SDL_Color get_color() const noexcept {
+				SDL_Color color{};
+				SDL_GetRenderDrawColor(renderer_, &color.r, &color.g, &color.b, &color.a);
+				return color;
+			}
+
+			SDL_BlendMode get_blend_mode() const noexcept {
+				SDL_BlendMode mode = SDL_BLENDMODE_NONE;
+				SDL_GetRenderDrawBlendMode(renderer_, &mode);
+				return mode;
+			}
+
+			/**
+			 * \brief forgets the shadowed render state, call this after changing it with SDL directly
+			 */
+			void invalidate_state() const noexcept {
+				state_ = State{};
+			}
+
+			const StateStats &state_stats() const noexcept {
+				return stats_;
+			}
+
+			void reset_state_stats() const noexcept {
+				stats_ = StateStats{};
+			}
+
 			void set_logical_size(int w, int h) const {
+				state_.viewport_known = state_.clip_known = false;
 				if (SDL_RenderSetLogicalSize(renderer_, w, h))
 					except::throw_exc();
 			}
@@ -81,7 +331,8 @@ namespace leap {
 			}
 
 			void copy(SDL_Texture *texture, const SDL_Rect *src = nullptr, const SDL_Rect *dst = nullptr) const {
-				if (SDL_RenderCopy(renderer_, texture, src, dst))
+				SDL_Rect moved;
+				if (SDL_RenderCopy(renderer_, texture, src, shift(dst, moved)))
 					except::throw_exc();
 			}
 
@@ -89,8 +340,30 @@ namespace leap {
 				copy(texture, &src, &dst);
 			}
 
+			/**
+			 * \brief renders a list of triangles, optionally textured, in a single driver call
+			 * \param texture the texture to sample from, or \c nullptr for colored triangles
+			 * \param vertices the vertex buffer
+			 * \param num_vertices the number of vertices
+			 * \param indices the index buffer, three indices per triangle(may be \c nullptr)
+			 * \param num_indices the number of indices
+			 */
+			void geometry(SDL_Texture *texture, const SDL_Vertex *vertices, int num_vertices,
+			              const int *indices = nullptr, int num_indices = 0) const {
+				if (shifted()) {
+					vertices_.assign(vertices, vertices + num_vertices);
+					for (auto &vertex : vertices_) {
+						vertex.position.x += static_cast<float>(offset_.x);
+						vertex.position.y += static_cast<float>(offset_.y);
+					}
+					vertices = vertices_.data();
+				}
+				if (SDL_RenderGeometry(renderer_, texture, vertices, num_vertices, indices, num_indices))
+					except::throw_exc();
+			}
+
 			void draw_point(int x, int y) const {
-				if (SDL_RenderDrawPoint(renderer_, x, y))
+				if (SDL_RenderDrawPoint(renderer_, x + offset_.x, y + offset_.y))
 					except::throw_exc();
 			}
 
@@ -99,7 +372,7 @@ namespace leap {
 			}
 
 			void draw_line(int x1, int y1, int x2, int y2) const {
-				if (SDL_RenderDrawLine(renderer_, x1, y1, x2, y2))
+				if (SDL_RenderDrawLine(renderer_, x1 + offset_.x, y1 + offset_.y, x2 + offset_.x, y2 + offset_.y))
 					except::throw_exc();
 			}
 
@@ -108,7 +381,8 @@ namespace leap {
 			}
 
 			void draw_rect(const SDL_Rect *rect) const {
-				if (SDL_RenderDrawRect(renderer_, rect))
+				SDL_Rect moved;
+				if (SDL_RenderDrawRect(renderer_, shift(rect, moved)))
 					except::throw_exc();
 			}
 
@@ -121,6 +395,85 @@ namespace leap {
 				draw_rect(&rect);
 			}
 
+			void fill_rect(const SDL_Rect *rect) const {
+				SDL_Rect moved;
+				if (SDL_RenderFillRect(renderer_, shift(rect, moved)))
+					except::throw_exc();
+			}
+
+			void fill_rect(int x, int y, int w, int h) const {
+				const SDL_Rect rect{x, y, w, h};
+				fill_rect(&rect);
+			}
+
+			void fill_rect(const IRect &rect) const {
+				fill_rect(&rect);
+			}
+
+			/**
+			 * \brief draws every point in one driver call
+			 * \param points the points to draw
+			 */
+			void draw_points(std::span<const IPoint> points) const {
+				points = shift(points, points_);
+				if (SDL_RenderDrawPoints(renderer_, points.data(), static_cast<int>(points.size())))
+					except::throw_exc();
+			}
+
+			void draw_points(std::span<const FPoint> points) const {
+				points = shift(points, fpoints_);
+				if (SDL_RenderDrawPointsF(renderer_, points.data(), static_cast<int>(points.size())))
+					except::throw_exc();
+			}
+
+			/**
+			 * \brief draws a polyline connecting every point in order in one driver call
+			 * \param points the points of the polyline
+			 */
+			void draw_lines(std::span<const IPoint> points) const {
+				points = shift(points, points_);
+				if (SDL_RenderDrawLines(renderer_, points.data(), static_cast<int>(points.size())))
+					except::throw_exc();
+			}
+
+			void draw_lines(std::span<const FPoint> points) const {
+				points = shift(points, fpoints_);
+				if (SDL_RenderDrawLinesF(renderer_, points.data(), static_cast<int>(points.size())))
+					except::throw_exc();
+			}
+
+			/**
+			 * \brief draws the outline of every rectangle in one driver call
+			 * \param rects the rectangles to draw
+			 */
+			void draw_rects(std::span<const IRect> rects) const {
+				rects = shift(rects, rects_);
+				if (SDL_RenderDrawRects(renderer_, rects.data(), static_cast<int>(rects.size())))
+					except::throw_exc();
+			}
+
+			void draw_rects(std::span<const FRect> rects) const {
+				rects = shift(rects, frects_);
+				if (SDL_RenderDrawRectsF(renderer_, rects.data(), static_cast<int>(rects.size())))
+					except::throw_exc();
+			}
+
+			/**
+			 * \brief fills every rectangle in one driver call
+			 * \param rects the rectangles to fill
+			 */
+			void fill_rects(std::span<const IRect> rects) const {
+				rects = shift(rects, rects_);
+				if (SDL_RenderFillRects(renderer_, rects.data(), static_cast<int>(rects.size())))
+					except::throw_exc();
+			}
+
+			void fill_rects(std::span<const FRect> rects) const {
+				rects = shift(rects, frects_);
+				if (SDL_RenderFillRectsF(renderer_, rects.data(), static_cast<int>(rects.size())))
+					except::throw_exc();
+			}
+
 			void clear() const {
 				if (SDL_RenderClear(renderer_))
 					except::throw_exc();
@@ -130,5 +483,60 @@ namespace leap {
 				SDL_RenderPresent(renderer_);
 			}
 		};
+
+		/**
+		 * \brief Redirects drawing to a target texture while alive, then restores the previous target,
+		 * clip rectangle, draw color and draw blend mode.
+		 */
+		class TargetScope {
+			const Renderer &renderer_;
+			SDL_Texture *target_;
+			SDL_Rect clip_;
+			bool clipped_;
+			SDL_Color color_;
+			SDL_BlendMode blend_;
+
+		public:
+			TargetScope(const Renderer &renderer, SDL_Texture *texture) :
+				renderer_(renderer), target_(renderer.get_target()), clip_(), clipped_(renderer.get_clip(clip_)),
+				color_(renderer.get_color()), blend_(renderer.get_blend_mode()) {
+				renderer.set_target(texture);
+			}
+
+			~TargetScope() noexcept {
+				try {
+					renderer_.set_target(target_);
+					if (clipped_)
+						renderer_.set_clip(&clip_);
+					renderer_.set_color(color_);
+					renderer_.set_blend_mode(blend_);
+				}
+				catch (const except::LeapException &) {
+					// the state is left as is, since a destructor must not throw
+				}
+			}
+
+			TargetScope(const TargetScope &) = delete;
+		};
+
+		/**
+		 * \brief Sets the offset of a Renderer while alive, then restores the previous one.
+		 */
+		class OffsetScope {
+			const Renderer &renderer_;
+			IPoint offset_;
+
+		public:
+			OffsetScope(const Renderer &renderer, const IPoint &offset) noexcept :
+				renderer_(renderer), offset_(renderer.get_offset()) {
+				renderer.set_offset(offset);
+			}
+
+			~OffsetScope() noexcept {
+				renderer_.set_offset(offset_);
+			}
+
+			OffsetScope(const OffsetScope &) = delete;
+		};
 	}
 }
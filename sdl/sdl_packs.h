@@ -4,9 +4,27 @@
 #include "except.hpp"
 #include "color.hpp"
 #include "position.hpp"
+#include "region.hpp"
+#include "damage.hpp"
+#include "spatial.hpp"
 #include "render.hpp"
 #include "event.hpp"
+#include "loop.hpp"
+#include "mailbox.hpp"
 #include "to_string.hpp"
 #include "texture.hpp"
+#include "kernel.hpp"
+#include "geometry.hpp"
 #include "surface.hpp"
-#include "pointer.hpp"
\ No newline at end of file
+#include "pointer.hpp"
+#include "pool.hpp"
+#include "worker.hpp"
+#include "parallel.hpp"
+#include "mipmap.hpp"
+#include "mapped.hpp"
+#include "pack.hpp"
+#include "atlas.hpp"
+#include "streaming.hpp"
+#include "batch.hpp"
+#include "primitive.hpp"
+#include "command.hpp"
\ No newline at end of file
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "const.h"
+#include "except.hpp"
+#include "position.hpp"
+#include <limits>
+#include <string>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+namespace leap {
+	namespace spatial {
+		/**
+		 * \brief A uniform grid of rectangles, for finding the rectangles at a point or over an area without
+		 * checking them all.
+		 * \details Each rectangle is listed in every cell it touches, so a point query checks only the rectangles of
+		 * one cell. Rectangles contain their right and bottom edges, as pos::Rect::contains does. Ids are handed
+		 * out in increasing order, so the last rectangle inserted has the largest id, which hit treats as topmost.
+		 * A cell a few times the size of a typical rectangle works best, as rectangles much larger than a cell are
+		 * listed in many cells.
+		 */
+		class Grid {
+		public:
+			using Id = size_t;
+			static constexpr Id none = std::numeric_limits<Id>::max();
+
+		private:
+			struct Cells {
+				int x0, y0, x1, y1;
+			};
+
+			int cell_size_;
+			Id next_id_ = 0;
+			size_t version_ = 0;
+			std::unordered_map<Id, pos::IRect> rects_;
+			std::unordered_map<Uint64, std::vector<Id>> cells_;
+
+			int cell_of(int coordinate) const noexcept {
+				// rounds towards negative infinity, so that cells do not double in size around 0
+				return coordinate >= 0 ? coordinate / cell_size_ : -((-coordinate - 1) / cell_size_) - 1;
+			}
+
+			Cells cells_of(const pos::IRect &rect) const noexcept {
+				return {cell_of(rect.x), cell_of(rect.y),
+				        cell_of(rect.x + std::max(rect.w, 0)), cell_of(rect.y + std::max(rect.h, 0))};
+			}
+
+			static Uint64 key(int x, int y) noexcept {
+				return static_cast<Uint64>(static_cast<Uint32>(x)) << 32 | static_cast<Uint32>(y);
+			}
+
+			void link(Id id, const pos::IRect &rect) {
+				const auto cells = cells_of(rect);
+				for (int y = cells.y0; y <= cells.y1; ++y)
+					for (int x = cells.x0; x <= cells.x1; ++x)
+						cells_[key(x, y)].push_back(id);
+			}
+
+			void unlink(Id id, const pos::IRect &rect) {
+				const auto cells = cells_of(rect);
+				for (int y = cells.y0; y <= cells.y1; ++y)
+					for (int x = cells.x0; x <= cells.x1; ++x) {
+						const auto it = cells_.find(key(x, y));
+						auto &ids = it->second;
+						ids.erase(std::find(ids.begin(), ids.end(), id));
+						if (ids.empty())
+							cells_.erase(it);
+					}
+			}
+
+			pos::IRect &find(Id id) {
+				const auto it = rects_.find(id);
+				if (it == rects_.end())
+					throw except::LeapException("no rectangle of id " + std::to_string(id) + " in the grid");
+				return it->second;
+			}
+
+			const pos::IRect &find(Id id) const {
+				return const_cast<Grid *>(this)->find(id);
+			}
+
+		public:
+			/**
+			 * \param cell_size the side of a cell in pixels
+			 */
+			explicit Grid(int cell_size = 64) : cell_size_(cell_size) {
+				if (cell_size <= 0)
+					throw except::LeapException("the cell size of a grid must be positive");
+			}
+
+			/**
+			 * \brief adds a rectangle
+			 * \return the id of the rectangle, larger than every id handed out before
+			 */
+			Id insert(const pos::IRect &rect) {
+				const Id id = next_id_++;
+				link(id, rect);
+				rects_.emplace(id, rect);
+				++version_;
+				return id;
+			}
+
+			/**
+			 * \brief replaces the rectangle of \c id
+			 * \throw LeapException if there is no rectangle of \c id
+			 */
+			void move(Id id, const pos::IRect &rect) {
+				auto &current = find(id);
+				const auto from = cells_of(current), to = cells_of(rect);
+				if (from.x0 != to.x0 || from.y0 != to.y0 || from.x1 != to.x1 || from.y1 != to.y1) {
+					unlink(id, current);
+					link(id, rect);
+				}
+				current = rect;
+				++version_;
+			}
+
+			/**
+			 * \brief removes the rectangle of \c id, if there is one
+			 */
+			void remove(Id id) {
+				const auto it = rects_.find(id);
+				if (it == rects_.end())
+					return;
+				unlink(id, it->second);
+				rects_.erase(it);
+				++version_;
+			}
+
+			void clear() noexcept {
+				rects_.clear();
+				cells_.clear();
+				++version_;
+			}
+
+			bool contains(Id id) const noexcept {
+				return rects_.find(id) != rects_.end();
+			}
+
+			const pos::IRect &rect(Id id) const {
+				return find(id);
+			}
+
+			size_t size() const noexcept {
+				return rects_.size();
+			}
+
+			/**
+			 * \brief a number that changes whenever the grid does, to tell whether a query has to be repeated
+			 */
+			size_t version() const noexcept {
+				return version_;
+			}
+
+			/**
+			 * \brief calls \c function(id) for every rectangle containing \c point, in no particular order
+			 */
+			template <typename Function>
+			void query(const pos::IPoint &point, Function &&function) const {
+				const auto it = cells_.find(key(cell_of(point.x), cell_of(point.y)));
+				if (it == cells_.end())
+					return;
+				for (const Id id : it->second)
+					if (rects_.find(id)->second.contains(point))
+						function(id);
+			}
+
+			/**
+			 * \brief calls \c function(id) once for every rectangle sharing any area with \c area, or touching it,
+			 * in no particular order
+			 */
+			template <typename Function>
+			void query(const pos::IRect &area, Function &&function) const {
+				const auto cells = cells_of(area);
+				const int right = area.x + std::max(area.w, 0), bottom = area.y + std::max(area.h, 0);
+				for (int y = cells.y0; y <= cells.y1; ++y)
+					for (int x = cells.x0; x <= cells.x1; ++x) {
+						const auto it = cells_.find(key(x, y));
+						if (it == cells_.end())
+							continue;
+						for (const Id id : it->second) {
+							const auto &rect = rects_.find(id)->second;
+							// a rectangle in several cells is reported by the first cell it shares with the area
+							const auto own = cells_of(rect);
+							if (x != std::max(own.x0, cells.x0) || y != std::max(own.y0, cells.y0))
+								continue;
+							if (rect.x <= right && area.x <= rect.x + std::max(rect.w, 0) &&
+							    rect.y <= bottom && area.y <= rect.y + std::max(rect.h, 0))
+								function(id);
+						}
+					}
+			}
+
+			/**
+			 * \return the ids of the rectangles containing \c point, in increasing order
+			 */
+			std::vector<Id> query(const pos::IPoint &point) const {
+				std::vector<Id> result;
+				query(point, [&result](Id id) { result.push_back(id); });
+				std::sort(result.begin(), result.end());
+				return result;
+			}
+
+			/**
+			 * \return the ids of the rectangles over \c area, in increasing order
+			 */
+			std::vector<Id> query(const pos::IRect &area) const {
+				std::vector<Id> result;
+				query(area, [&result](Id id) { result.push_back(id); });
+				std::sort(result.begin(), result.end());
+				return result;
+			}
+
+			/**
+			 * \return the topmost rectangle containing \c point, the one inserted last, or \c none
+			 */
+			Id hit(const pos::IPoint &point) const {
+				Id result = none;
+				query(point, [&result](Id id) {
+					if (result == none || id > result)
+						result = id;
+				});
+				return result;
+			}
+		};
+
+		using GridPtr = std::shared_ptr<Grid>;
+
+		template <typename... Types>
+		GridPtr make_grid(Types &&... args) {
+			return std::make_shared<Grid>(std::forward<Types>(args)...);
+		}
+	}
+
+	namespace pointer {
+		using spatial::GridPtr;
+		using spatial::make_grid;
+	}
+}
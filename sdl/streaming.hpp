@@ -0,0 +1,211 @@
+#pragma once
+
+#include "const.h"
+#include "except.hpp"
+#include "position.hpp"
+#include "render.hpp"
+#include "texture.hpp"
+#include "pointer.hpp"
+#include <vector>
+#include <span>
+
+namespace leap {
+	namespace texture {
+		/**
+		 * \brief A texture with several buffers that the CPU writes into directly, for video frames, plots and the like.
+		 * \details Writes go into the back buffer while the front buffer, the last one completed, is drawn,
+		 * so the CPU does not wait for the GPU to finish with a texture. A buffer may miss the areas written
+		 * into the other buffers since its own last write, so locking a part of it also locks those areas,
+		 * and the producer must rewrite the whole locked rectangle.
+		 */
+		class StreamingTexture {
+			std::vector<pointer::TexturePtr> buffers_;
+			// per buffer, the area written into other buffers since the buffer was last written
+			std::vector<pos::IRect> stale_;
+			pos::IPoint size_;
+			Uint32 format_;
+			size_t front_ = 0;
+			bool has_frame_ = false;
+
+			size_t back() const noexcept {
+				return has_frame_ ? (front_ + 1) % buffers_.size() : 0;
+			}
+
+			void publish(size_t index, const pos::IRect &area) {
+				for (size_t i = 0; i < stale_.size(); ++i)
+					stale_[i] = i == index ? pos::IRect() : stale_[i].united(area);
+				front_ = index;
+				has_frame_ = true;
+			}
+
+		public:
+			/**
+			 * \brief the pixels of a locked buffer, which is unlocked and becomes the front buffer when destroyed
+			 * \details an empty lock holds no buffer, has no pixels and leaves the front buffer as it is
+			 */
+			class Lock {
+				StreamingTexture *owner_;
+				size_t index_;
+				// rect_ is the locked area, changed_ the part of it with new content
+				pos::IRect rect_, changed_;
+				void *pixels_;
+				int pitch_;
+
+				friend class StreamingTexture;
+
+				Lock(StreamingTexture *owner, size_t index, const pos::IRect &rect, const pos::IRect &changed,
+				     void *pixels, int pitch) noexcept :
+					owner_(owner), index_(index), rect_(rect), changed_(changed), pixels_(pixels), pitch_(pitch) {}
+
+			public:
+				Lock(Lock &&other) noexcept :
+					owner_(other.owner_), index_(other.index_), rect_(other.rect_), changed_(other.changed_),
+					pixels_(other.pixels_),
+					pitch_(other.pitch_) {
+					other.owner_ = nullptr;
+				}
+
+				Lock(const Lock &) = delete;
+				Lock &operator=(const Lock &) = delete;
+
+				~Lock() noexcept {
+					if (owner_) {
+						SDL_UnlockTexture(owner_->buffers_[index_]->get());
+						owner_->publish(index_, changed_);
+					}
+				}
+
+				/**
+				 * \brief the locked area in texture coordinates, which the producer must rewrite entirely
+				 */
+				const pos::IRect &rect() const noexcept {
+					return rect_;
+				}
+
+				void *pixels() const noexcept {
+					return pixels_;
+				}
+
+				int pitch() const noexcept {
+					return pitch_;
+				}
+
+				std::span<std::byte> bytes() const noexcept {
+					return {static_cast<std::byte *>(pixels_), static_cast<size_t>(pitch_) * rect_.h};
+				}
+
+				/**
+				 * \brief a row of the locked area
+				 * \tparam Pixel the type of a pixel, which must match the size of the texture format
+				 * \param y the row, relative to the top of the locked area
+				 */
+				template <typename Pixel = Uint32>
+				std::span<Pixel> row(int y) const noexcept {
+					return {reinterpret_cast<Pixel *>(static_cast<std::byte *>(pixels_) + static_cast<size_t>(y) * pitch_),
+					        static_cast<size_t>(rect_.w)};
+				}
+			};
+
+			/**
+			 * \param renderer the renderer to create the buffers with
+			 * \param size the size of the texture
+			 * \param format the pixel format, one of the \c SDL_PixelFormatEnum values
+			 * \param buffers the number of buffers, 2 for double and 3 for triple buffering
+			 */
+			StreamingTexture(const render::Renderer &renderer, const pos::IPoint &size,
+			                 Uint32 format = SDL_PIXELFORMAT_ARGB8888, size_t buffers = 2) :
+				stale_(buffers == 0 ? 1 : buffers, pos::IRect(0, 0, size.x, size.y)), size_(size), format_(format) {
+				for (size_t i = 0; i < stale_.size(); ++i)
+					buffers_.push_back(
+						pointer::make_texture(renderer.create_texture(format, SDL_TEXTUREACCESS_STREAMING, size)));
+			}
+
+			StreamingTexture(const StreamingTexture &) = delete;
+
+			/**
+			 * \brief locks a part of the back buffer for writing
+			 * \param rect the part to write, the lock may cover more, see Lock::rect
+			 * \return the lock, which must be released before the next lock. It is empty when \c rect is outside the
+			 * texture and the back buffer is up to date, as SDL backends differ on locking an empty area
+			 */
+			Lock lock(const pos::IRect &rect) {
+				const size_t index = back();
+				const pos::IRect full(0, 0, size_.x, size_.y);
+				const pos::IRect changed = rect.intersection(full), area = changed.united(stale_[index]);
+				if (area.empty())
+					return Lock(nullptr, index, area, changed, nullptr, 0);
+				void *pixels;
+				int pitch;
+				if (SDL_LockTexture(buffers_[index]->get(), &area, &pixels, &pitch))
+					except::throw_exc();
+				return Lock(this, index, area, changed, pixels, pitch);
+			}
+
+			Lock lock() {
+				return lock(pos::IRect(0, 0, size_.x, size_.y));
+			}
+
+			/**
+			 * \brief copies a whole frame into the back buffer, and makes it the front buffer
+			 * \param pixels the frame, in the format of the texture
+			 * \param pitch the length of a row of \c pixels in bytes
+			 */
+			void update(const void *pixels, int pitch) {
+				const size_t index = back();
+				if (SDL_UpdateTexture(buffers_[index]->get(), nullptr, pixels, pitch))
+					except::throw_exc();
+				publish(index, pos::IRect(0, 0, size_.x, size_.y));
+			}
+
+			/**
+			 * \brief the buffer completed last, which is the one drawn
+			 */
+			const pointer::TexturePtr &front() const noexcept {
+				return buffers_[front_];
+			}
+
+			bool has_frame() const noexcept {
+				return has_frame_;
+			}
+
+			const pos::IPoint &size() const noexcept {
+				return size_;
+			}
+
+			Uint32 format() const noexcept {
+				return format_;
+			}
+
+			size_t buffer_count() const noexcept {
+				return buffers_.size();
+			}
+
+			void copy_to(const render::Renderer &renderer, const pos::IPoint &dst) const {
+				if (has_frame_)
+					front()->copy_to(renderer, dst);
+			}
+
+			void copy_to(const render::Renderer &renderer, const pos::IRect &dst) const {
+				if (has_frame_)
+					front()->copy_to(renderer, dst);
+			}
+
+			void copy_to(const render::Renderer &renderer, const pos::IRect &src, const pos::IRect &dst) const {
+				if (has_frame_)
+					front()->copy_to(renderer, src, dst);
+			}
+		};
+
+		using StreamingTexturePtr = std::shared_ptr<StreamingTexture>;
+
+		template <typename... Types>
+		StreamingTexturePtr make_streaming_texture(Types &&... args) {
+			return std::make_shared<StreamingTexture>(std::forward<Types>(args)...);
+		}
+	}
+
+	namespace pointer {
+		using texture::StreamingTexturePtr;
+		using texture::make_streaming_texture;
+	}
+}
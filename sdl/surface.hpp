@@ -5,11 +5,102 @@
 #include "position.hpp"
 #include "render.hpp"
 #include "texture.hpp"
+#include "kernel.hpp"
+#include <span>
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <algorithm>
 
 namespace leap {
 	namespace surface {
+		/**
+		 * \brief how copying a Surface treats its pixels
+		 */
+		enum class CopyMode {
+			// copies the pixels at once
+			deep,
+			// shares the pixels until one side is written to
+			shared
+		};
+
+		struct CopyStats {
+			// pixel copies made and the bytes they took
+			size_t copies, bytes;
+			// copies made by sharing pixels instead
+			size_t shares;
+		};
+
+		namespace detail {
+			struct CopyCounters {
+				std::atomic<size_t> copies{0}, bytes{0}, shares{0};
+			};
+
+			inline CopyCounters &copy_counters() noexcept {
+				static CopyCounters counters;
+				return counters;
+			}
+		}
+
+		/**
+		 * \brief counts of pixel copies made by Surface since the start or the last reset_copy_stats
+		 */
+		inline CopyStats copy_stats() noexcept {
+			const auto &counters = detail::copy_counters();
+			return {counters.copies.load(), counters.bytes.load(), counters.shares.load()};
+		}
+
+		inline void reset_copy_stats() noexcept {
+			auto &counters = detail::copy_counters();
+			counters.copies = 0;
+			counters.bytes = 0;
+			counters.shares = 0;
+		}
+
+		/**
+		 * \brief An owned SDL_Surface.
+		 * \details With CopyMode::shared, copies share one SDL_Surface through its reference count, and the
+		 * writing methods of a Surface copy the pixels first if they are shared. Writing through get() or row()
+		 * does not, so call detach() or mutable_pixels() before. Sharing is not thread-safe, as the reference
+		 * count of SDL_Surface is not atomic.
+		 */
 		class Surface {
-			SDL_Surface *surface_;
+			// mutable, as the writing methods are const and may have to detach shared pixels
+			mutable SDL_Surface *surface_;
+			CopyMode mode_ = CopyMode::deep;
+			// set for pixels the SDL_Surface does not own, which must not outlive their owner
+			bool deep_only_ = false;
+
+			SDL_Surface *share() const noexcept {
+				++surface_->refcount;
+				++detail::copy_counters().shares;
+				return surface_;
+			}
+
+			template <typename Function>
+			static void with_lock(SDL_Surface *surface, Function &&function) {
+				const bool lock = SDL_MUSTLOCK(surface);
+				if (lock && SDL_LockSurface(surface))
+					except::throw_exc();
+				function();
+				if (lock)
+					SDL_UnlockSurface(surface);
+			}
+
+			/**
+			 * \brief applies a kernel to every row of a rectangle clipped to the clip rectangle
+			 */
+			template <typename Function>
+			void for_rows(const pos::IRect &rect, Function &&function) const {
+				const SDL_Rect &clip = surface_->clip_rect;
+				const auto area = rect.intersection(pos::IRect(clip.x, clip.y, clip.w, clip.h));
+				if (area.empty())
+					return;
+				with_lock(surface_, [&] {
+					for (int y = area.y; y < area.y + area.h; ++y)
+						function(row(y) + area.x, static_cast<size_t>(area.w), area.x, y);
+				});
+			}
 
 		public:
 			explicit Surface(SDL_Surface *surface) noexcept : surface_(surface) {}
@@ -28,8 +119,34 @@ namespace leap {
 			explicit Surface(const pos::IPoint &size) :
 				Surface(size, 32) { }
 
+			/**
+			 * \brief copies the pixels, or shares them if the copy mode of \c surface is CopyMode::shared
+			 */
 			Surface(const Surface &surface) :
-				surface_(surface.copy()) { }
+				surface_(surface.mode_ == CopyMode::shared ? surface.share() : surface.copy()), mode_(surface.mode_) { }
+
+			Surface(Surface &&surface) noexcept :
+				surface_(std::exchange(surface.surface_, nullptr)), mode_(surface.mode_), deep_only_(surface.deep_only_) { }
+
+			Surface &operator=(const Surface &surface) {
+				if (this != &surface) {
+					SDL_Surface *copied = surface.mode_ == CopyMode::shared ? surface.share() : surface.copy();
+					SDL_FreeSurface(surface_);
+					surface_ = copied;
+					mode_ = surface.mode_;
+				}
+				return *this;
+			}
+
+			Surface &operator=(Surface &&surface) noexcept {
+				if (this != &surface) {
+					SDL_FreeSurface(surface_);
+					surface_ = std::exchange(surface.surface_, nullptr);
+					mode_ = surface.mode_;
+					deep_only_ = surface.deep_only_;
+				}
+				return *this;
+			}
 
 			~Surface() {
 				SDL_FreeSurface(surface_);
@@ -58,9 +175,89 @@ namespace leap {
 				SDL_Surface *surface = SDL_ConvertSurface(surface_, surface_->format, 0);
 				if (surface == nullptr)
 					except::throw_exc();
+				auto &counters = detail::copy_counters();
+				++counters.copies;
+				counters.bytes += static_cast<size_t>(surface->pitch) * surface->h;
 				return surface;
 			}
 
+			/**
+			 * \throw LeapException if \c mode is CopyMode::shared after forbid_sharing
+			 */
+			void set_copy_mode(CopyMode mode) {
+				if (mode == CopyMode::shared && deep_only_)
+					throw except::LeapException("the pixels of this surface cannot be shared");
+				mode_ = mode;
+			}
+
+			/**
+			 * \brief keeps the copy mode deep for good, for pixels the SDL_Surface does not own, such as pooled ones
+			 */
+			void forbid_sharing() noexcept {
+				mode_ = CopyMode::deep;
+				deep_only_ = true;
+			}
+
+			CopyMode copy_mode() const noexcept {
+				return mode_;
+			}
+
+			/**
+			 * \brief whether the pixels are shared with another Surface or holder of the SDL_Surface
+			 */
+			bool is_shared() const noexcept {
+				return surface_ != nullptr && surface_->refcount > 1;
+			}
+
+			/**
+			 * \brief makes the pixels owned by this Surface alone, copying them if they are shared
+			 */
+			void detach() const {
+				if (!is_shared())
+					return;
+				SDL_Surface *copied = copy();
+				SDL_FreeSurface(surface_);
+				surface_ = copied;
+			}
+
+			/**
+			 * \brief the pixels for reading, which must be locked if SDL_MUSTLOCK says so
+			 */
+			std::span<const std::byte> pixels() const noexcept {
+				return {static_cast<const std::byte *>(surface_->pixels), static_cast<size_t>(surface_->pitch) * surface_->h};
+			}
+
+			/**
+			 * \brief the pixels for writing, copied first if shared
+			 */
+			std::span<std::byte> mutable_pixels() const {
+				detach();
+				return {static_cast<std::byte *>(surface_->pixels), static_cast<size_t>(surface_->pitch) * surface_->h};
+			}
+
+			/**
+			 * \brief the pixels of row \c y of a 32-bit surface, which must be locked if SDL_MUSTLOCK says so
+			 */
+			Uint32 *row(int y) const noexcept {
+				return reinterpret_cast<Uint32 *>(static_cast<Uint8 *>(surface_->pixels) + static_cast<size_t>(y) * surface_->pitch);
+			}
+
+			/**
+			 * \brief whether the format is ARGB8888 or ABGR8888, the formats the alpha kernels work on
+			 */
+			bool has_top_alpha() const noexcept {
+				std::array<int, 4> shifts;
+				return kernel::channel_shifts(surface_->format->format, shifts) && shifts[0] == 24;
+			}
+
+			/**
+			 * \brief calls \c function with the surface locked if it needs to be
+			 */
+			template <typename Function>
+			void locked(Function &&function) const {
+				with_lock(surface_, std::forward<Function>(function));
+			}
+
 			Uint32 map_rgb(Uint8 r, Uint8 g, Uint8 b) const noexcept {
 				return SDL_MapRGB(surface_->format, r, g, b);
 			}
@@ -70,6 +267,7 @@ namespace leap {
 			}
 
 			void set_color_key(Uint32 rgb, SDL_bool flag = SDL_TRUE) const {
+				detach();
 				SDL_SetColorKey(surface_, flag, rgb);
 			}
 
@@ -77,12 +275,222 @@ namespace leap {
 				set_color_key(map_rgb(color), flag);
 			}
 
+			/**
+			 * \brief fills the clip rectangle with an opaque color, as SDL_FillRect does
+			 */
 			void fill(const SDL_Color &color) const {
-				SDL_FillRect(surface_, nullptr, map_rgb(color));
+				fill(color, get_range());
 			}
 
+			/**
+			 * \brief fills a rectangle with an opaque color, clipped as SDL_FillRect does
+			 * \details 32-bit surfaces are filled by the SIMD kernels
+			 */
 			void fill(const SDL_Color &color, const SDL_Rect &dst_rect) const {
-				SDL_FillRect(surface_, &dst_rect, map_rgb(color));
+				detach();
+				if (surface_->format->BytesPerPixel != 4) {
+					SDL_FillRect(surface_, &dst_rect, map_rgb(color));
+					return;
+				}
+				const Uint32 value = map_rgb(color);
+				for_rows(pos::IRect(dst_rect.x, dst_rect.y, dst_rect.w, dst_rect.h), [value](Uint32 *pixels, size_t n, int, int) {
+					kernel::fill(pixels, n, value);
+				});
+			}
+
+			/**
+			 * \brief blends a surface over this surface
+			 * \details when this surface is ARGB8888 or ABGR8888, the SIMD kernels blend by \c mode regardless of
+			 * the blend mode of \c src, which is first converted to the same format if needed. Other surfaces
+			 * are blitted, which only Blend::straight allows
+			 * \param src the surface to draw
+			 * \param dst where to draw \c src
+			 * \param mode how the colors mix, Blend::premultiplied needs both surfaces premultiplied
+			 * \throw LeapException if \c mode is not Blend::straight and this surface is of another format
+			 */
+			void blend(const Surface &src, const pos::IPoint &dst, kernel::Blend mode = kernel::Blend::straight) const {
+				if (!has_top_alpha()) {
+					if (mode != kernel::Blend::straight)
+						throw except::LeapException("blending other than straight needs alpha in the top byte");
+					blit(src, dst);
+					return;
+				}
+				if (src->format->format != surface_->format->format) {
+					blend(Surface(src.convert(surface_->format->format)), dst, mode);
+					return;
+				}
+				detach();
+				const auto target = src.get_range() + dst;
+				with_lock(src.get(), [&] {
+					for_rows(target, [&](Uint32 *pixels, size_t n, int x, int y) {
+						kernel::blend(pixels, src.row(y - dst.y) + (x - dst.x), n, mode);
+					});
+				});
+			}
+
+			/**
+			 * \brief changes the brightness of every pixel by \c value, as color::Color::dim
+			 * \throw LeapException if the surface is not of 32 bits
+			 */
+			void dim(int value) const {
+				if (surface_->format->BytesPerPixel != 4)
+					throw except::LeapException("dim needs a surface of 32 bits");
+				detach();
+				const Uint32 keep = surface_->format->Amask;
+				with_lock(surface_, [&] {
+					for (int y = 0; y < surface_->h; ++y)
+						kernel::dim(row(y), static_cast<size_t>(surface_->w), value, keep);
+				});
+			}
+
+			/**
+			 * \brief multiplies the color of every pixel by its alpha
+			 * \throw LeapException if the format is not ARGB8888 or ABGR8888
+			 */
+			void premultiply() const {
+				if (!has_top_alpha())
+					throw except::LeapException("premultiply needs alpha in the top byte");
+				detach();
+				with_lock(surface_, [this] {
+					for (int y = 0; y < surface_->h; ++y)
+						kernel::premultiply(row(y), static_cast<size_t>(surface_->w));
+				});
+			}
+
+			/**
+			 * \brief divides the color of every pixel by its alpha, reverting premultiply up to rounding
+			 * \throw LeapException if the format is not ARGB8888 or ABGR8888
+			 */
+			void unpremultiply() const {
+				if (!has_top_alpha())
+					throw except::LeapException("unpremultiply needs alpha in the top byte");
+				detach();
+				with_lock(surface_, [this] {
+					for (int y = 0; y < surface_->h; ++y)
+						kernel::unpremultiply(row(y), static_cast<size_t>(surface_->w));
+				});
+			}
+
+			/**
+			 * \brief copies the surface into a new surface of another format
+			 * \details conversions between ARGB8888, RGBA8888, ABGR8888 and BGRA8888 use the SIMD kernels,
+			 * any other goes through SDL_ConvertSurfaceFormat
+			 * \return the new surface, owned by the caller
+			 */
+			SDL_Surface *convert(Uint32 format) const {
+				kernel::Swizzle swizzle;
+				if (!kernel::make_swizzle(surface_->format->format, format, swizzle)) {
+					SDL_Surface *surface = SDL_ConvertSurfaceFormat(surface_, format, 0);
+					if (surface == nullptr)
+						except::throw_exc();
+					return surface;
+				}
+				SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, surface_->w, surface_->h, 32, format);
+				if (surface == nullptr)
+					except::throw_exc();
+				with_lock(surface_, [&] {
+					for (int y = 0; y < surface_->h; ++y)
+						kernel::swizzle(reinterpret_cast<Uint32 *>(static_cast<Uint8 *>(surface->pixels) + static_cast<size_t>(y) * surface->pitch),
+						                row(y), static_cast<size_t>(surface_->w), swizzle);
+				});
+				return surface;
+			}
+
+			/**
+			 * \brief averages each 2x2 block of pixels into a new surface of half the size
+			 * \details the last row or column of an odd size is dropped, a side of 1 pixel stays 1 pixel.
+			 * Surfaces of 32 bits keep their format and are scaled by the SIMD kernels, which treat every byte
+			 * alike, others are converted to ARGB8888 first. Premultiplied alpha avoids dark fringes
+			 * \return the new surface, owned by the caller
+			 */
+			SDL_Surface *half() const {
+				if (surface_->format->BytesPerPixel != 4)
+					return Surface(convert(SDL_PIXELFORMAT_ARGB8888)).half();
+				const int sw = surface_->w, sh = surface_->h;
+				const int w = std::max(1, sw / 2), h = std::max(1, sh / 2);
+				SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, surface_->format->format);
+				if (surface == nullptr)
+					except::throw_exc();
+				with_lock(surface_, [&] {
+					Uint32 column[4];
+					for (int y = 0; y < h; ++y) {
+						const Uint32 *row0 = row(std::min(y * 2, sh - 1)), *row1 = row(std::min(y * 2 + 1, sh - 1));
+						if (sw == 1) {
+							column[0] = column[1] = row0[0];
+							column[2] = column[3] = row1[0];
+							row0 = column;
+							row1 = column + 2;
+						}
+						kernel::half(reinterpret_cast<Uint32 *>(static_cast<Uint8 *>(surface->pixels) + static_cast<size_t>(y) * surface->pitch),
+						             row0, row1, static_cast<size_t>(w));
+					}
+				});
+				return surface;
+			}
+
+			/**
+			 * \brief scales the surface into a new surface of any size by bilinear interpolation
+			 * \details each pixel mixes the 2x2 source pixels around its center, so shrinking by more than half
+			 * skips pixels and aliases, which downscale avoids. Formats are treated as by half
+			 * \return the new surface, owned by the caller
+			 */
+			SDL_Surface *bilinear(const pos::IPoint &size) const {
+				if (surface_->format->BytesPerPixel != 4)
+					return Surface(convert(SDL_PIXELFORMAT_ARGB8888)).bilinear(size);
+				if (size.x <= 0 || size.y <= 0)
+					throw except::LeapException("cannot scale to an empty size");
+				const int sw = surface_->w, sh = surface_->h;
+				SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, size.x, size.y, 32, surface_->format->format);
+				if (surface == nullptr)
+					except::throw_exc();
+				// the source position of the center of each destination pixel in 1/256 of a pixel, split into
+				// the left or upper source pixel and the weight of the next one, which always exists
+				const auto sample = [](int i, int from, int to, int &index, int &weight) {
+					const long long position = std::clamp<long long>(((2LL * i + 1) * from * 256) / (2LL * to) - 128,
+					                                                 0, (from - 1) * 256LL);
+					index = static_cast<int>(position >> 8);
+					weight = static_cast<int>(position & 255);
+					if (index == from - 1 && from > 1) {
+						--index;
+						weight = 256;
+					}
+				};
+				std::vector<int> xs(static_cast<size_t>(size.x)), fxs(static_cast<size_t>(size.x));
+				for (int x = 0; x < size.x; ++x)
+					sample(x, sw, size.x, xs[static_cast<size_t>(x)], fxs[static_cast<size_t>(x)]);
+				with_lock(surface_, [&] {
+					Uint32 column[4];
+					for (int y = 0; y < size.y; ++y) {
+						int y0 = 0, fy = 0;
+						sample(y, sh, size.y, y0, fy);
+						const Uint32 *row0 = row(y0), *row1 = row(std::min(y0 + 1, sh - 1));
+						if (sw == 1) {
+							column[0] = column[1] = row0[0];
+							column[2] = column[3] = row1[0];
+							row0 = column;
+							row1 = column + 2;
+						}
+						kernel::bilinear(reinterpret_cast<Uint32 *>(static_cast<Uint8 *>(surface->pixels) + static_cast<size_t>(y) * surface->pitch),
+						                 row0, row1, fy, xs.data(), fxs.data(), static_cast<size_t>(size.x));
+					}
+				});
+				return surface;
+			}
+
+			/**
+			 * \brief shrinks the surface without aliasing: halves it while it stays at least \c size, then
+			 * interpolates the rest of the way bilinearly
+			 * \return the new surface, owned by the caller
+			 */
+			SDL_Surface *downscale(const pos::IPoint &size) const {
+				if (size.x <= 0 || size.y <= 0)
+					throw except::LeapException("cannot scale to an empty size");
+				if (surface_->w / 2 < size.x || surface_->h / 2 < size.y)
+					return bilinear(size);
+				Surface halved(half());
+				while (halved->w / 2 >= size.x && halved->h / 2 >= size.y)
+					halved = Surface(halved.half());
+				return halved.bilinear(size);
 			}
 
 			pos::IPoint get_size() const noexcept {
@@ -93,7 +501,8 @@ namespace leap {
 				return {0, 0, surface_->w, surface_->h};
 			}
 
-			void blit(SDL_Surface *src, const SDL_Rect *src_rect, SDL_Rect *dst_rect) const noexcept {
+			void blit(SDL_Surface *src, const SDL_Rect *src_rect, SDL_Rect *dst_rect) const {
+				detach();
 				if (SDL_BlitSurface(src, src_rect, surface_, dst_rect))
 					except::throw_exc();
 			}
@@ -4,17 +4,31 @@
 #include "except.hpp"
 #include "position.hpp"
 #include "render.hpp"
+#include <memory>
 
 namespace leap {
 	namespace texture {
 		class Texture {
 			SDL_Texture *texture_;
+			// set for a sub texture, which shows a region of the parent instead of owning a texture
+			std::shared_ptr<Texture> parent_;
+			pos::IRect region_;
 
 		public:
 			explicit Texture(SDL_Texture *texture) noexcept : texture_(texture) {}
 
+			/**
+			 * \brief creates a sub texture, which behaves like a texture of the size of \c region
+			 * \details the sub texture follows the parent when the parent is reset, and keeps the parent alive
+			 * \param parent the texture to show a region of
+			 * \param region the region of the parent, in pixels
+			 */
+			Texture(std::shared_ptr<Texture> parent, const pos::IRect &region) noexcept :
+				texture_(nullptr), parent_(std::move(parent)), region_(region) {}
+
 			~Texture() noexcept {
-				SDL_DestroyTexture(texture_);
+				if (!parent_)
+					SDL_DestroyTexture(texture_);
 			}
 
 			Texture() = delete;
@@ -25,40 +39,76 @@ namespace leap {
 			}
 
 			operator SDL_Texture*() const noexcept {
-				return texture_;
+				return get();
 			}
 
 			SDL_Texture *operator *() const noexcept {
-				return texture_;
+				return get();
 			}
 
 			SDL_Texture *get() const noexcept {
-				return texture_;
+				return parent_ ? parent_->get() : texture_;
+			}
+
+			/**
+			 * \brief replaces the texture owned, sub textures of this texture follow the replacement
+			 * \param texture the new texture
+			 */
+			void reset(SDL_Texture *texture) noexcept {
+				if (!parent_)
+					SDL_DestroyTexture(texture_);
+				parent_.reset();
+				texture_ = texture;
+			}
+
+			bool is_sub() const noexcept {
+				return parent_ != nullptr;
 			}
 
 			pos::IPoint query_size() const noexcept {
+				if (parent_)
+					return region_.size();
 				int w, h;
 				SDL_QueryTexture(texture_, nullptr, nullptr, &w, &h);
 				return {w, h};
 			}
 
 			pos::IRect query_range() const noexcept {
-				int w, h;
-				SDL_QueryTexture(texture_, nullptr, nullptr, &w, &h);
-				return {0, 0, w, h};
+				const auto size = query_size();
+				return {0, 0, size.x, size.y};
+			}
+
+			/**
+			 * \brief the part of get() that this texture shows
+			 * \return the region of a sub texture, or the whole range of any other texture
+			 */
+			pos::IRect source_range() const noexcept {
+				return parent_ ? region_ : query_range();
+			}
+
+			/**
+			 * \brief maps a rectangle of this texture to a rectangle of get()
+			 */
+			pos::IRect to_source(const pos::IRect &src) const noexcept {
+				return parent_ ? src + region_.left_up() : src;
+			}
+
+			void set_blend_mode(SDL_BlendMode mode) const {
+				if (SDL_SetTextureBlendMode(get(), mode))
+					except::throw_exc();
 			}
 
 			void copy_to(const render::Renderer &renderer, const pos::IPoint &dst) const {
-				const auto range = query_range();
-				renderer.copy(texture_, range, range + dst);
+				const auto range = source_range();
+				renderer.copy(get(), range, query_range() + dst);
 			}
 
 			void copy_to(const render::Renderer &renderer, const pos::IRect &dst) const {
-				renderer.copy(texture_, query_range(), dst);
+				renderer.copy(get(), source_range(), dst);
 			}
 
 			void copy_to(const render::Renderer &renderer, const pos::IRect &src, const pos::IRect &dst) const {
-				renderer.copy(texture_, src, dst);
+				renderer.copy(get(), to_source(src), dst);
 			}
 		};
 	}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "const.h"
+#include <deque>
+#include <algorithm>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <future>
+#include <vector>
+#include <functional>
+#include <type_traits>
+#include <condition_variable>
+
+namespace leap {
+	namespace worker {
+		/**
+		 * \brief A fixed set of threads running submitted jobs in submission order.
+		 * \details The destructor runs every job already submitted before joining the threads.
+		 */
+		class WorkerPool {
+			std::vector<std::thread> threads_;
+			std::deque<std::function<void()>> jobs_;
+			std::mutex mutex_;
+			std::condition_variable ready_;
+			bool stopping_ = false;
+
+			void run() {
+				for (;;) {
+					std::function<void()> job;
+					{
+						std::unique_lock lock(mutex_);
+						ready_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+						if (jobs_.empty())
+							return;
+						job = std::move(jobs_.front());
+						jobs_.pop_front();
+					}
+					job();
+				}
+			}
+
+		public:
+			/**
+			 * \param threads the number of threads, one per hardware thread if 0
+			 */
+			explicit WorkerPool(size_t threads = 0) {
+				if (threads == 0)
+					threads = std::max(1u, std::thread::hardware_concurrency());
+				threads_.reserve(threads);
+				for (size_t i = 0; i < threads; ++i)
+					threads_.emplace_back(&WorkerPool::run, this);
+			}
+
+			WorkerPool(const WorkerPool &) = delete;
+
+			~WorkerPool() noexcept {
+				{
+					std::lock_guard lock(mutex_);
+					stopping_ = true;
+				}
+				ready_.notify_all();
+				for (auto &thread : threads_)
+					thread.join();
+			}
+
+			/**
+			 * \brief queues a job
+			 * \param job the job, exceptions thrown by it are passed to the future
+			 * \return the future of the result of the job
+			 */
+			template <typename Function>
+			std::future<std::invoke_result_t<Function>> submit(Function &&job) {
+				using Result = std::invoke_result_t<Function>;
+				auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(job));
+				auto future = task->get_future();
+				{
+					std::lock_guard lock(mutex_);
+					jobs_.emplace_back([task] { (*task)(); });
+				}
+				ready_.notify_one();
+				return future;
+			}
+
+			size_t size() const noexcept {
+				return threads_.size();
+			}
+		};
+
+		using WorkerPoolPtr = std::shared_ptr<WorkerPool>;
+
+		template <typename... Types>
+		WorkerPoolPtr make_worker_pool(Types &&... args) {
+			return std::make_shared<WorkerPool>(std::forward<Types>(args)...);
+		}
+	}
+
+	namespace pointer {
+		using worker::WorkerPoolPtr;
+		using worker::make_worker_pool;
+	}
+}
@@ -19,7 +19,6 @@ int main(int argc, char **argv) {
 	auto renderer = pointer::make_renderer(*window, 0, SDL_RENDERER_ACCELERATED);
 	renderer->set_logical_size(1920, 1080);
 
-	event::Event event;
 	auto mouse = pointer::make_mouse();
 	auto key_map = pointer::make_key_map();
 
@@ -35,18 +34,20 @@ int main(int argc, char **argv) {
 
 	pos::Rect range = { 500, 300, 600, 300 };
 
+	auto atlas = pointer::make_atlas(*renderer);
+
 	auto style = button::make_style(
-		button::make_style_bit(*renderer, dark_blue, grey, font_fam->at(30)->render_blended("Dogs!", white), range.size(), 3),
-		button::make_style_bit(*renderer, light_blue, grey, font_fam->at(30)->render_blended("Cats!", white), range.size(), 3),
-		button::make_style_bit(*renderer, light_blue, white, font_fam->at(40)->render_blended("Doggies!", black), range.size(), 3)
+		button::make_style_bit(*atlas, dark_blue, grey, font_fam->at(30)->render_blended("Dogs!", white), range.size(), 3),
+		button::make_style_bit(*atlas, light_blue, grey, font_fam->at(30)->render_blended("Cats!", white), range.size(), 3),
+		button::make_style_bit(*atlas, light_blue, white, font_fam->at(40)->render_blended("Doggies!", black), range.size(), 3)
 	);
 
 	button::Button button(button::mouse::make_detector(mouse), button::mouse::make_clicker(mouse), button::make_drawer(style), range);
 
 	pos::Rect ip_range = { 1200, 500, 500, 200 };
 	auto ip_style = input_box::make_style(
-		input_box::make_style_bit(*renderer, dark_blue, grey, font_fam->at(30)->render_blended("Input here!", white), ip_range.size(), 3),
-		input_box::make_style_bit(*renderer, light_blue, grey, nullptr, ip_range.size(), 3)
+		input_box::make_style_bit(*atlas, dark_blue, grey, font_fam->at(30)->render_blended("Input here!", white), ip_range.size(), 3),
+		input_box::make_style_bit(*atlas, light_blue, grey, nullptr, ip_range.size(), 3)
 	);
 	input_box::InputBox input_box{
 		input_box::mouse::make_focus_changer(mouse),
@@ -57,44 +58,30 @@ int main(int argc, char **argv) {
 			ip_range
 	};
 
-
-	bool quit = false;
-	while (!quit) {
-		event.poll();
-		switch (event->type) {
-		case SDL_QUIT:
-			quit = true;
-			break;
-		case SDL_MOUSEBUTTONDOWN:
-		case SDL_MOUSEBUTTONUP:
-			mouse->button(event->button);
-			break;
-		case SDL_MOUSEMOTION:
-			mouse->motion(event->motion);
-			break;
-		case SDL_KEYDOWN:
-			key_map->key_down(event->key.keysym.sym);
-			break;
-		case SDL_KEYUP:
-			key_map->key_up(event->key.keysym.sym);
-		default:
-			break;
-		}
-
-		renderer->set_color(black);
-		renderer->clear();
-
-		text.update();
-		text.draw(*renderer);
-
-		button.update();
-		button.draw(*renderer);
-
-		input_box.update();
-		input_box.draw(*renderer);
-
-		renderer->present();
-	}
+	canvas::Canvas canvas{*renderer, {1920, 1080}, black};
+	canvas.add(text);
+	canvas.add(button);
+	canvas.add(input_box);
+
+	event::Pump pump;
+	event::Loop loop(pump);
+	// widgets changing outside of input, e.g. from a timer, get a frame drawn
+	canvas.set_invalidate_handler([&loop] { loop.request_redraw(); });
+	pump.on(SDL_QUIT, [&loop](const SDL_Event &) { loop.stop(); });
+	pump.on(SDL_WINDOWEVENT, [&canvas](const SDL_Event &) { canvas.invalidate(); });
+	pump.on(SDL_MOUSEBUTTONDOWN, [&mouse](const SDL_Event &e) { mouse->button(e.button); });
+	pump.on(SDL_MOUSEBUTTONUP, [&mouse](const SDL_Event &e) { mouse->button(e.button); });
+	pump.on(SDL_MOUSEMOTION, [&mouse](const SDL_Event &e) { mouse->motion(e.motion); });
+	pump.on(SDL_KEYDOWN, [&key_map](const SDL_Event &e) { key_map->key_down(e.key.keysym.sym); });
+	pump.on(SDL_KEYUP, [&key_map](const SDL_Event &e) { key_map->key_up(e.key.keysym.sym); });
+
+	loop.run([&] {
+		canvas.update();
+		mouse->end_frame();
+		key_map->end_frame();
+		if (canvas.draw())
+			renderer->present();
+	});
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdio>
+
+// The checks of the test programs: a failed check is reported with its place, and fails the program at the end.
+namespace check {
+	inline int &failures() noexcept {
+		static int count = 0;
+		return count;
+	}
+
+	inline void expect(bool condition, const char *what, const char *file, int line) {
+		if (condition)
+			return;
+		++failures();
+		std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+	}
+
+	/**
+	 * \return the exit status of the test program
+	 */
+	inline int finish(const char *name) {
+		if (failures() != 0) {
+			std::fprintf(stderr, "%s: %d checks failed\n", name, failures());
+			return 1;
+		}
+		std::printf("%s: passed\n", name);
+		return 0;
+	}
+}
+
+#define CHECK(condition) ::check::expect((condition), #condition, __FILE__, __LINE__)
@@ -0,0 +1,255 @@
+#include "../sdl/sdl_packs.h"
+#include "check.hpp"
+#include <array>
+#include <random>
+#include <vector>
+
+#undef main
+
+// Checks the batches of sdl/color.hpp on every instruction set against the Color methods they run, over every
+// channel value, and that every sRGB level survives the trip through linear light.
+using namespace leap;
+
+namespace {
+	using color::Color;
+	using Colors = std::vector<Color>;
+
+	constexpr std::array<kernel::Isa, 3> isas = {kernel::Isa::scalar, kernel::Isa::sse2, kernel::Isa::avx2};
+
+	std::mt19937 generator(22);
+
+	Uint8 random_level() {
+		return static_cast<Uint8>(generator());
+	}
+
+	Color random_color() {
+		return {random_level(), random_level(), random_level(), random_level()};
+	}
+
+	Colors random_colors(size_t n) {
+		Colors colors;
+		colors.reserve(n);
+		for (size_t i = 0; i < n; ++i)
+			colors.push_back(random_color());
+		return colors;
+	}
+
+	/**
+	 * \brief whether the colors are the same, printing the first few which differ
+	 */
+	bool same(const Colors &actual, const Colors &expected, const char *name) {
+		if (actual.size() != expected.size())
+			return false;
+		int reported = 0;
+		for (size_t i = 0; i < actual.size() && reported < 4; ++i) {
+			if (actual[i].pack() == expected[i].pack())
+				continue;
+			std::fprintf(stderr, "%s on instruction set %d at %zu: %08x, expected %08x\n", name,
+			             static_cast<int>(kernel::isa()), i, actual[i].pack(), expected[i].pack());
+			++reported;
+		}
+		return reported == 0;
+	}
+
+	/**
+	 * \brief runs \c function on every instruction set, and checks that it gives \c expected on each
+	 * \param function returns the colors written
+	 */
+	template <typename Function>
+	void on_every_isa(const char *name, const Colors &expected, Function &&function) {
+		for (const auto isa : isas) {
+			kernel::limit_isa(isa);
+			CHECK(same(function(), expected, name));
+		}
+		kernel::limit_isa(kernel::Isa::avx2);
+	}
+
+	// the constant SSE2 divides by 255 with, for every value (c1 * a1 + c2 * a2) >> 1 of merge can take
+	void division() {
+		bool exact = true;
+		for (Uint32 value = 0; value <= (255 * 255 + 255 * 255) >> 1; ++value)
+			exact = exact && ((value * 0x8081) >> 16) >> 7 == value / 255;
+		CHECK(exact);
+	}
+
+	// every pair of alphas, each with 256 colors which cover every channel value on both sides, the two extremes
+	// together, and random pairs on a length which leaves tails after the vector loops
+	void merge() {
+		Colors lhs, rhs;
+		for (int a1 = 0; a1 < 256; ++a1)
+			for (int a2 = 0; a2 < 256; ++a2)
+				for (int c = 0; c < 256; ++c) {
+					const auto level = static_cast<Uint8>(c);
+					lhs.emplace_back(level, static_cast<Uint8>(255 - c), level, static_cast<Uint8>(a1));
+					rhs.emplace_back(static_cast<Uint8>(255 - c), level, level, static_cast<Uint8>(a2));
+				}
+		const auto random_lhs = random_colors(1031), random_rhs = random_colors(1031);
+		lhs.insert(lhs.end(), random_lhs.begin(), random_lhs.end());
+		rhs.insert(rhs.end(), random_rhs.begin(), random_rhs.end());
+
+		Colors expected;
+		expected.reserve(lhs.size());
+		for (size_t i = 0; i < lhs.size(); ++i)
+			expected.push_back(lhs[i].merge(rhs[i]));
+		on_every_isa("merge", expected, [&] {
+			Colors out(lhs.size(), Color(0, 0, 0, 0));
+			color::merge(lhs, rhs, out);
+			return out;
+		});
+		// in place, as the batches allow
+		on_every_isa("merge in place", expected, [&] {
+			Colors out = lhs;
+			color::merge(out, rhs, out);
+			return out;
+		});
+	}
+
+	// every pair of channel values, with random alphas which the result must drop to 0 as Color::merge_rgb does
+	void merge_rgb() {
+		Colors lhs, rhs;
+		for (int c1 = 0; c1 < 256; ++c1)
+			for (int c2 = 0; c2 < 256; ++c2) {
+				const auto x = static_cast<Uint8>(c1), y = static_cast<Uint8>(c2);
+				lhs.emplace_back(x, y, x, random_level());
+				rhs.emplace_back(y, x, y, random_level());
+			}
+		const auto random_lhs = random_colors(1031), random_rhs = random_colors(1031);
+		lhs.insert(lhs.end(), random_lhs.begin(), random_lhs.end());
+		rhs.insert(rhs.end(), random_rhs.begin(), random_rhs.end());
+
+		Colors expected;
+		expected.reserve(lhs.size());
+		bool transparent = true;
+		for (size_t i = 0; i < lhs.size(); ++i) {
+			expected.push_back(lhs[i].merge_rgb(rhs[i]));
+			transparent = transparent && expected.back().a == 0;
+		}
+		CHECK(transparent);
+		on_every_isa("merge_rgb", expected, [&] {
+			Colors out(lhs.size(), Color(1, 2, 3, 4));
+			color::merge_rgb(lhs, rhs, out);
+			return out;
+		});
+	}
+
+	// every channel value with every change which clamps, and changes past 255 either way
+	void dim() {
+		Colors colors;
+		for (int c = 0; c < 256; ++c)
+			colors.emplace_back(static_cast<Uint8>(c), static_cast<Uint8>(255 - c), random_level(), random_level());
+		const auto random = random_colors(1031);
+		colors.insert(colors.end(), random.begin(), random.end());
+
+		for (int value = -300; value <= 300; ++value) {
+			Colors expected;
+			expected.reserve(colors.size());
+			for (const auto &color : colors)
+				expected.push_back(color.dim(value));
+			on_every_isa("dim", expected, [&] {
+				Colors out = colors;
+				color::dim(out, value);
+				return out;
+			});
+		}
+	}
+
+	void premultiply() {
+		const auto colors = random_colors(1031);
+		Colors premultiplied, unpremultiplied;
+		for (const auto &color : colors) {
+			premultiplied.push_back(color.premultiplied());
+			unpremultiplied.push_back(color.premultiplied().unpremultiplied());
+		}
+		on_every_isa("premultiply", premultiplied, [&] {
+			Colors out = colors;
+			color::premultiply(out);
+			return out;
+		});
+		on_every_isa("unpremultiply", unpremultiplied, [&] {
+			Colors out = premultiplied;
+			color::unpremultiply(out);
+			return out;
+		});
+	}
+
+	void blend() {
+		const auto dst = random_colors(1031), src = random_colors(1031);
+		for (const auto mode : {kernel::Blend::straight, kernel::Blend::premultiplied, kernel::Blend::linear}) {
+			Colors base = dst, over = src;
+			if (mode == kernel::Blend::premultiplied) {
+				color::premultiply(base);
+				color::premultiply(over);
+			}
+			Colors expected;
+			for (size_t i = 0; i < base.size(); ++i)
+				expected.push_back(base[i].blended(over[i], mode));
+			on_every_isa("blend", expected, [&] {
+				Colors out = base;
+				color::blend(out, over, mode);
+				return out;
+			});
+		}
+	}
+
+	// the sRGB tables, and the gradients built on them
+	void linear() {
+		bool round_trip = true, increasing = true;
+		for (int level = 0; level < 256; ++level) {
+			const auto value = static_cast<Uint8>(level);
+			round_trip = round_trip && kernel::from_linear(kernel::to_linear(value)) == value;
+			increasing = increasing && (level == 0 || kernel::to_linear(value) > kernel::to_linear(value - 1));
+		}
+		CHECK(round_trip);
+		CHECK(increasing);
+		CHECK(kernel::to_linear(0) == 0 && kernel::to_linear(255) == 65535);
+
+		// the ends of a gradient are its colors exactly, in either space
+		for (int i = 0; i < 64; ++i) {
+			const Color from = random_color(), to = random_color();
+			for (const auto space : {color::Space::srgb, color::Space::linear}) {
+				Colors out(7, Color(0, 0, 0, 0));
+				color::gradient(out, from, to, space);
+				CHECK(out.front().pack() == from.pack());
+				CHECK(out.back().pack() == to.pack());
+				Colors one(1, Color(0, 0, 0, 0));
+				color::gradient(one, from, to, space);
+				CHECK(one.front().pack() == from.pack());
+			}
+		}
+		// in linear light, the middle of black and white is lighter than the sRGB middle
+		Colors grey(3, Color(0, 0, 0, 0));
+		color::gradient(grey, Color(0, 0, 0, 255), Color(255, 255, 255, 255), color::Space::linear);
+		CHECK(grey[1].r > 128 && grey[1].r == grey[1].g && grey[1].g == grey[1].b);
+	}
+
+	void sizes() {
+		const auto lhs = random_colors(5), rhs = random_colors(4);
+		Colors out(5, Color(0, 0, 0, 0));
+		bool thrown = false;
+		try {
+			color::merge(lhs, rhs, out);
+		}
+		catch (const except::LeapException &) {
+			thrown = true;
+		}
+		CHECK(thrown);
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		division();
+		merge();
+		merge_rgb();
+		dim();
+		premultiply();
+		blend();
+		linear();
+		sizes();
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return check::finish("color");
+}
@@ -0,0 +1,209 @@
+#include "../sdl/sdl_packs.h"
+#include "check.hpp"
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#undef main
+
+// Checks that replaying a CommandBuffer draws what the same calls draw on the renderer directly, on a software
+// renderer. The blocks are small, so that spans fill blocks up, move on to new ones and outgrow the block size,
+// and the buffers are replayed again after reset() and after being moved.
+using namespace leap;
+
+namespace {
+	constexpr int size = 64;
+	constexpr size_t block_size = 256;
+
+	std::mt19937 generator(6);
+
+	int random(int low, int high) {
+		return low + static_cast<int>(generator() % static_cast<unsigned>(high - low + 1));
+	}
+
+	struct Scene {
+		SDL_Texture *texture = nullptr;
+		std::vector<pos::IPoint> points;
+		std::vector<pos::FPoint> fpoints;
+		std::vector<pos::IRect> rects;
+		std::vector<pos::FRect> frects;
+		std::vector<SDL_Vertex> vertices;
+		std::vector<int> indices;
+	};
+
+	/**
+	 * \brief random shapes, \c count of each kind, partly outside the target
+	 */
+	Scene make_scene(SDL_Texture *texture, size_t count) {
+		Scene scene;
+		scene.texture = texture;
+		for (size_t i = 0; i < count; ++i) {
+			scene.points.emplace_back(random(-4, size + 4), random(-4, size + 4));
+			scene.fpoints.emplace_back(static_cast<float>(random(-4, size + 4)) + 0.5f, static_cast<float>(random(-4, size + 4)));
+			scene.rects.emplace_back(random(-8, size), random(-8, size), random(0, 16), random(0, 16));
+			scene.frects.emplace_back(static_cast<float>(random(-8, size)), static_cast<float>(random(-8, size)) + 0.25f,
+			                          static_cast<float>(random(0, 16)), static_cast<float>(random(0, 16)));
+		}
+		// an odd number of triangles, so that the vertices take a size which is not a multiple of 8
+		for (size_t i = 0; i < count / 6 * 6 + 3; ++i) {
+			SDL_Vertex vertex{};
+			vertex.position = {static_cast<float>(random(0, size)), static_cast<float>(random(0, size))};
+			vertex.color = {static_cast<Uint8>(generator()), static_cast<Uint8>(generator()), static_cast<Uint8>(generator()), 255};
+			vertex.tex_coord = {static_cast<float>(random(0, 8)) / 8, static_cast<float>(random(0, 8)) / 8};
+			scene.vertices.push_back(vertex);
+		}
+		for (size_t i = 0; i + 2 < scene.vertices.size(); ++i)
+			scene.indices.insert(scene.indices.end(), {static_cast<int>(i), static_cast<int>(i + 1), static_cast<int>(i + 2)});
+		return scene;
+	}
+
+	/**
+	 * \brief issues every kind of command on \c target, a Renderer or a CommandBuffer
+	 */
+	template <typename Target>
+	void draw(Target &target, const Scene &scene) {
+		target.reset_target();
+		target.reset_viewport();
+		target.reset_clip();
+		target.set_blend_mode(SDL_BLENDMODE_NONE);
+		target.set_color(20, 30, 40, 255);
+		target.clear();
+
+		target.set_blend_mode(SDL_BLENDMODE_BLEND);
+		target.set_color(200, 10, 10, 128);
+		target.fill_rects(scene.rects);
+		target.set_color(SDL_Color{10, 200, 10, 255});
+		target.draw_rects(scene.frects);
+		target.draw_lines(scene.points);
+		target.set_clip(pos::IRect(4, 4, size - 12, size - 20));
+		target.set_color(250, 250, 10, 200);
+		target.fill_rects(scene.frects);
+		target.draw_rects(scene.rects);
+		target.draw_lines(scene.fpoints);
+		target.draw_points(scene.points);
+		target.draw_points(scene.fpoints);
+		target.draw_point(pos::IPoint(5, 6));
+		target.draw_line(pos::IPoint(0, size - 1), pos::IPoint(size - 1, 0));
+		target.draw_rect(pos::IRect(3, 3, 20, 10));
+		target.fill_rect(pos::IRect(30, 30, 5, 7));
+		target.copy(scene.texture, pos::IRect(0, 0, 4, 8), pos::IRect(40, 2, 16, 16));
+		target.reset_clip();
+		target.copy(scene.texture);
+
+		target.set_viewport(pos::IRect(8, 8, size / 2, size / 2));
+		const std::span<const int> indices = scene.indices;
+		if constexpr (std::is_same_v<Target, command::CommandBuffer>) {
+			target.geometry(nullptr, scene.vertices);
+			target.geometry(scene.texture, scene.vertices, indices);
+		}
+		else {
+			target.geometry(nullptr, scene.vertices.data(), static_cast<int>(scene.vertices.size()));
+			target.geometry(scene.texture, scene.vertices.data(), static_cast<int>(scene.vertices.size()),
+			                indices.data(), static_cast<int>(indices.size()));
+		}
+		target.reset_viewport();
+	}
+
+	std::vector<Uint32> read_pixels(const render::Renderer &renderer) {
+		std::vector<Uint32> pixels(size * size);
+		if (SDL_RenderReadPixels(renderer.get(), nullptr, SDL_PIXELFORMAT_ARGB8888, pixels.data(), size * 4))
+			except::throw_exc();
+		return pixels;
+	}
+
+	/**
+	 * \brief the pixels drawn by \c function, after the renderer forgot the state the previous drawing left
+	 */
+	template <typename Function>
+	std::vector<Uint32> drawn(const render::Renderer &renderer, Function &&function) {
+		renderer.invalidate_state();
+		function();
+		return read_pixels(renderer);
+	}
+
+	SDL_Texture *make_texture(const render::Renderer &renderer) {
+		SDL_Texture *texture = renderer.create_texture(SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, 8, 8);
+		Uint32 pixels[64];
+		for (auto &pixel : pixels)
+			pixel = generator() | 0xff000000u;
+		if (SDL_UpdateTexture(texture, nullptr, pixels, 8 * 4))
+			except::throw_exc();
+		return texture;
+	}
+
+	void replay(const render::Renderer &renderer, SDL_Texture *texture) {
+		// more points than fit a block, which gets a block of its own
+		const Scene large = make_scene(texture, 60), small = make_scene(texture, 7);
+		command::CommandBuffer buffer(0, block_size);
+		draw(buffer, large);
+		CHECK(buffer.capacity() > 4 * block_size);
+		const auto expected = drawn(renderer, [&] { draw(renderer, large); });
+		CHECK(drawn(renderer, [&] { buffer.replay(renderer); }) == expected);
+
+		// the same commands again reuse the blocks
+		const size_t capacity = buffer.capacity(), commands = buffer.size();
+		buffer.reset();
+		CHECK(buffer.empty());
+		draw(buffer, large);
+		CHECK(buffer.capacity() == capacity && buffer.size() == commands);
+		CHECK(drawn(renderer, [&] { buffer.replay(renderer); }) == expected);
+
+		// fewer and smaller commands leave the later blocks unused, which must not be replayed
+		buffer.reset();
+		draw(buffer, small);
+		const auto expected_small = drawn(renderer, [&] { draw(renderer, small); });
+		CHECK(drawn(renderer, [&] { buffer.replay(renderer); }) == expected_small);
+
+		// a moved buffer replays what was recorded, the one moved from records into new blocks
+		command::CommandBuffer moved(std::move(buffer));
+		CHECK(buffer.empty() && moved.size() != 0);
+		CHECK(drawn(renderer, [&] { moved.replay(renderer); }) == expected_small);
+		draw(buffer, large);
+		CHECK(drawn(renderer, [&] { buffer.replay(renderer); }) == expected);
+		moved = std::move(buffer);
+		CHECK(drawn(renderer, [&] { moved.replay(renderer); }) == expected);
+	}
+
+	// buffers replayed together go by their order, and keep their relative position within the same order
+	void order(const render::Renderer &renderer, SDL_Texture *texture) {
+		const Scene back = make_scene(texture, 20), front = make_scene(texture, 5);
+		command::CommandBuffer first(1, block_size), second(1, block_size), background(0, block_size);
+		first.set_color(0, 0, 255, 255);
+		first.fill_rects(front.rects);
+		second.set_color(255, 0, 255, 255);
+		second.fill_rects(front.frects);
+		draw(background, back);
+		command::CommandBuffer *buffers[] = {&first, &background, &second};
+
+		const auto expected = drawn(renderer, [&] {
+			draw(renderer, back);
+			renderer.set_color(0, 0, 255, 255);
+			renderer.fill_rects(front.rects);
+			renderer.set_color(255, 0, 255, 255);
+			renderer.fill_rects(front.frects);
+		});
+		CHECK(drawn(renderer, [&] { command::replay(renderer, buffers); }) == expected);
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		SDL_Surface *canvas = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_ARGB8888);
+		if (canvas == nullptr)
+			except::throw_exc();
+		const surface::Surface owner(canvas);
+		SDL_Renderer *software = SDL_CreateSoftwareRenderer(canvas);
+		if (software == nullptr)
+			except::throw_exc();
+		const render::Renderer renderer(software);
+		SDL_Texture *texture = make_texture(renderer);
+		replay(renderer, texture);
+		order(renderer, texture);
+		SDL_DestroyTexture(texture);
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return check::finish("command");
+}
@@ -0,0 +1,221 @@
+#include "../sdl/sdl_packs.h"
+#include "check.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#undef main
+
+// Checks RectArray and PointArray on the scalar and SSE2 paths against loops calling the Rect member functions they
+// replace, which they must match exactly, on lengths around the 4 lanes and on empty and negative rectangles.
+using namespace leap;
+
+namespace {
+	constexpr size_t lengths[] = {0, 1, 3, 4, 5, 7, 8, 13, 1027};
+
+	std::mt19937 generator(21);
+
+	// whole numbers for int, quarters for float, so that float sums are exact and the results comparable
+	template <typename Arithmetic>
+	Arithmetic random(int low, int high) {
+		const int value = low + static_cast<int>(generator() % static_cast<unsigned>(high - low + 1));
+		if constexpr (std::is_floating_point_v<Arithmetic>)
+			return static_cast<Arithmetic>(value) / 4 + static_cast<Arithmetic>(generator() % 4) / 4;
+		else
+			return value;
+	}
+
+	// about a fifth of the rectangles have a zero or negative width or height
+	template <typename Arithmetic>
+	pos::Rect<Arithmetic> random_rect() {
+		return {random<Arithmetic>(-50, 50), random<Arithmetic>(-50, 50), random<Arithmetic>(-8, 30), random<Arithmetic>(-8, 30)};
+	}
+
+	template <typename Arithmetic>
+	bool same(const pos::Rect<Arithmetic> &a, const pos::Rect<Arithmetic> &b) {
+		return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+	}
+
+	template <typename Arithmetic>
+	bool same(const pos::RectArray<Arithmetic> &array, const std::vector<pos::Rect<Arithmetic>> &rects) {
+		if (array.size() != rects.size())
+			return false;
+		for (size_t i = 0; i < rects.size(); ++i)
+			if (!same(array[i], rects[i]))
+				return false;
+		return true;
+	}
+
+	template <typename Arithmetic>
+	bool same(const pos::PointArray<Arithmetic> &array, const std::vector<pos::Point<Arithmetic>> &points) {
+		if (array.size() != points.size())
+			return false;
+		for (size_t i = 0; i < points.size(); ++i)
+			if (array[i].x != points[i].x || array[i].y != points[i].y)
+				return false;
+		return true;
+	}
+
+	template <typename Arithmetic>
+	void rects(size_t n) {
+		using Rect = pos::Rect<Arithmetic>;
+		using Point = pos::Point<Arithmetic>;
+		std::vector<Rect> source(n);
+		for (auto &rect : source)
+			rect = random_rect<Arithmetic>();
+		const Point offset(random<Arithmetic>(-20, 20), random<Arithmetic>(-20, 20));
+		const Point origin(random<Arithmetic>(-20, 20), random<Arithmetic>(-20, 20));
+		const Arithmetic factors[] = {Arithmetic(3), Arithmetic(-2), Arithmetic(0)};
+		// probes inside, across the edges of, and away from the rectangles, and empty ones
+		const Rect probes[] = {{-10, -10, 20, 20}, {-60, -60, 200, 200}, {40, 40, 30, 30}, {300, 300, 5, 5},
+		                       {0, 0, 0, 10}, {0, 0, 10, -3}};
+		const Point points[] = {{0, 0}, {-50, -50}, {80, 80}, {13, -7}, {100, 100}};
+
+		for (const auto isa : {kernel::Isa::scalar, kernel::Isa::sse2}) {
+			kernel::limit_isa(isa);
+			const pos::RectArray<Arithmetic> array(source);
+
+			std::vector<Rect> stored(n);
+			array.store(stored);
+			CHECK(same(array, source));
+			CHECK(std::equal(stored.begin(), stored.end(), source.begin(), [](const Rect &a, const Rect &b) {
+				return same(a, b);
+			}));
+			CHECK(array.to_rects().size() == n);
+
+			auto moved = array;
+			moved.translate(offset);
+			std::vector<Rect> expected = source;
+			for (auto &rect : expected)
+				rect = Rect(rect.x + offset.x, rect.y + offset.y, rect.w, rect.h);
+			CHECK(same(moved, expected));
+
+			for (const Arithmetic m : factors) {
+				auto expanded = array;
+				expanded.expand(origin, m);
+				for (size_t i = 0; i < n; ++i)
+					expected[i] = source[i].expand(origin, m);
+				CHECK(same(expanded, expected));
+			}
+
+			std::vector<Uint8> mask(n);
+			for (const auto &point : points) {
+				array.contains(point, mask);
+				for (size_t i = 0; i < n; ++i)
+					CHECK(mask[i] == source[i].contains(point));
+			}
+
+			for (const auto &probe : probes) {
+				array.intersects(probe, mask);
+				for (size_t i = 0; i < n; ++i)
+					CHECK(mask[i] == source[i].intersects(probe));
+
+				auto clipped = array;
+				clipped.clip(probe);
+				for (size_t i = 0; i < n; ++i)
+					expected[i] = source[i].intersection(probe);
+				CHECK(same(clipped, expected));
+			}
+
+			Rect bounds;
+			for (const auto &rect : source)
+				bounds = bounds.united(rect);
+			const Rect actual = array.bounds();
+			CHECK(same(actual, bounds) || (actual.empty() && bounds.empty()));
+		}
+		kernel::limit_isa(kernel::Isa::avx2);
+	}
+
+	template <typename Arithmetic>
+	void points(size_t n) {
+		using Rect = pos::Rect<Arithmetic>;
+		using Point = pos::Point<Arithmetic>;
+		std::vector<Point> source(n);
+		for (auto &point : source)
+			point = Point(random<Arithmetic>(-50, 50), random<Arithmetic>(-50, 50));
+		const Point offset(random<Arithmetic>(-20, 20), random<Arithmetic>(-20, 20));
+		const Point origin(random<Arithmetic>(-20, 20), random<Arithmetic>(-20, 20));
+		const Rect probes[] = {{-10, -10, 20, 20}, {-50, -50, 100, 100}, {0, 0, 0, 0}, {10, 10, -5, 5}};
+
+		for (const auto isa : {kernel::Isa::scalar, kernel::Isa::sse2}) {
+			kernel::limit_isa(isa);
+			const pos::PointArray<Arithmetic> array(source);
+			CHECK(same(array, source));
+
+			auto moved = array;
+			moved.translate(offset);
+			std::vector<Point> expected = source;
+			for (auto &point : expected)
+				point = Point(point.x + offset.x, point.y + offset.y);
+			CHECK(same(moved, expected));
+
+			auto expanded = array;
+			expanded.expand(origin, Arithmetic(-3));
+			for (size_t i = 0; i < n; ++i) {
+				const Rect corner = Rect(source[i].x, source[i].y, 0, 0).expand(origin, Arithmetic(-3));
+				expected[i] = Point(corner.x, corner.y);
+			}
+			CHECK(same(expanded, expected));
+
+			std::vector<Uint8> mask(n);
+			for (const auto &probe : probes) {
+				array.inside(probe, mask);
+				for (size_t i = 0; i < n; ++i)
+					CHECK(mask[i] == probe.contains(source[i]));
+			}
+
+			const Rect bounds = array.bounds();
+			if (n == 0)
+				CHECK(bounds.empty());
+			else {
+				bool all_inside = true;
+				for (const auto &point : source)
+					all_inside = all_inside && bounds.contains(point);
+				CHECK(all_inside);
+				// every edge of the bounds has a point on it
+				bool left = false, top = false, right = false, bottom = false;
+				for (const auto &point : source) {
+					left = left || point.x == bounds.x;
+					top = top || point.y == bounds.y;
+					right = right || point.x == bounds.x + bounds.w;
+					bottom = bottom || point.y == bounds.y + bounds.h;
+				}
+				CHECK(left && top && right && bottom);
+			}
+		}
+		kernel::limit_isa(kernel::Isa::avx2);
+	}
+
+	void spans() {
+		const std::vector<pos::IRect> source = {{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}};
+		pos::IRectArray array(source);
+		std::vector<pos::IRect> wrong(2);
+		bool thrown = false;
+		try {
+			array.store(wrong);
+		}
+		catch (const except::LeapException &) {
+			thrown = true;
+		}
+		CHECK(thrown);
+		array.push_back({13, 14, 15, 16});
+		CHECK(array.size() == 4 && same(array[3], pos::IRect(13, 14, 15, 16)));
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		for (const size_t n : lengths) {
+			rects<int>(n);
+			rects<float>(n);
+			points<int>(n);
+			points<float>(n);
+		}
+		spans();
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return check::finish("geometry");
+}
@@ -0,0 +1,103 @@
+#include "../input/input_packs.h"
+#include "check.hpp"
+
+#undef main
+
+// Checks that Mouse and KeyMap latch the presses and releases of a frame until end_frame, fed with events directly.
+using namespace leap;
+
+namespace {
+	SDL_MouseButtonEvent button_event(Uint32 type, Uint8 button, int x = 0, int y = 0) {
+		SDL_MouseButtonEvent event{};
+		event.type = type;
+		event.button = button;
+		event.x = x;
+		event.y = y;
+		return event;
+	}
+
+	template <typename Function>
+	bool throws(Function &&function) {
+		try {
+			function();
+		}
+		catch (const except::LeapException &) {
+			return true;
+		}
+		return false;
+	}
+
+	void mouse() {
+		using namespace input::mouse;
+		Mouse mouse;
+
+		// pressed and released between two updates
+		mouse.button(button_event(SDL_MOUSEBUTTONDOWN, left, 10, 20));
+		mouse.button(button_event(SDL_MOUSEBUTTONUP, left, 10, 20));
+		CHECK(mouse.pressed(left));
+		CHECK(mouse.released(left));
+		CHECK(!mouse.pressed(right) && !mouse.released(right));
+		CHECK(mouse.get_position().x == 10 && mouse.get_position().y == 20);
+		mouse.end_frame();
+		CHECK(!mouse.pressed(left));
+		CHECK(!mouse.released(left));
+
+		// held over a frame, then released in the next one
+		mouse.button(button_event(SDL_MOUSEBUTTONDOWN, right));
+		CHECK(mouse.pressed(right) && !mouse.released(right));
+		mouse.end_frame();
+		CHECK(mouse.pressed(right) && !mouse.released(right));
+		mouse.button(button_event(SDL_MOUSEBUTTONUP, right));
+		CHECK(!mouse.pressed(right) && mouse.released(right));
+		mouse.end_frame();
+		CHECK(!mouse.pressed(right) && !mouse.released(right));
+
+		CHECK(throws([&] { mouse.released(wheel_up); }));
+		CHECK(throws([&] { mouse.pressed(0); }));
+	}
+
+	void keys() {
+		input::keys::KeyMap keys;
+
+		// pressed and released between two updates
+		keys.key_down(SDLK_a);
+		keys.key_up(SDLK_a);
+		CHECK(keys.is_down(SDLK_a));
+		CHECK(keys.pressed() == SDLK_a);
+		CHECK(keys.released(SDLK_a));
+		keys.end_frame();
+		CHECK(keys.is_up(SDLK_a));
+		CHECK(keys.pressed() == SDLK_UNKNOWN);
+		CHECK(!keys.released(SDLK_a));
+
+		// held over a frame, then released in the next one
+		keys.key_down(SDLK_b);
+		keys.end_frame();
+		CHECK(keys.is_down(SDLK_b) && keys.pressed() == SDLK_b && !keys.released(SDLK_b));
+		keys.key_up(SDLK_b);
+		CHECK(keys.is_up(SDLK_b) && keys.pressed() == SDLK_UNKNOWN && keys.released(SDLK_b));
+		keys.end_frame();
+		CHECK(!keys.released(SDLK_b));
+
+		// a tap during a held key reads as the last key pressed, and leaves the held key down
+		keys.key_down(SDLK_c);
+		keys.end_frame();
+		keys.key_down(SDLK_d);
+		keys.key_up(SDLK_d);
+		CHECK(keys.is_down(SDLK_c) && keys.is_down(SDLK_d) && keys.pressed() == SDLK_d);
+		keys.end_frame();
+		CHECK(keys.is_down(SDLK_c) && keys.is_up(SDLK_d));
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		mouse();
+		keys();
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return check::finish("input");
+}
@@ -0,0 +1,277 @@
+#include "../sdl/sdl_packs.h"
+#include "check.hpp"
+#include <array>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#undef main
+
+// Checks the pixel kernels against SDL, and every instruction set against the scalar kernels.
+using namespace leap;
+
+namespace {
+	constexpr std::array<kernel::Isa, 3> isas = {kernel::Isa::scalar, kernel::Isa::sse2, kernel::Isa::avx2};
+	constexpr std::array<Uint32, 4> formats = {
+		SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGBA8888, SDL_PIXELFORMAT_ABGR8888, SDL_PIXELFORMAT_BGRA8888
+	};
+	// SDL's blitters divide by 256 where the kernels round x / 255 to nearest, and SDL_PremultiplyAlpha truncates
+	constexpr int blend_tolerance = 2, premultiply_tolerance = 1;
+
+	std::mt19937 generator(2024);
+
+	int difference(Uint32 a, Uint32 b) noexcept {
+		int result = 0;
+		for (int shift = 0; shift < 32; shift += 8)
+			result = std::max(result, std::abs(static_cast<int>((a >> shift) & 0xff) - static_cast<int>((b >> shift) & 0xff)));
+		return result;
+	}
+
+	surface::Surface make(int w, int h, Uint32 format = SDL_PIXELFORMAT_ARGB8888) {
+		SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, format);
+		if (surface == nullptr)
+			except::throw_exc();
+		return surface::Surface(surface);
+	}
+
+	void randomize(const surface::Surface &surface) {
+		for (int y = 0; y < surface->h; ++y)
+			for (int x = 0; x < surface->w; ++x)
+				surface.row(y)[x] = generator();
+	}
+
+	std::vector<Uint32> random_pixels(size_t n) {
+		std::vector<Uint32> pixels(n);
+		for (auto &pixel : pixels)
+			pixel = generator();
+		return pixels;
+	}
+
+	/**
+	 * \brief runs \c function on every instruction set, and checks that each gives what the scalar one gives
+	 * \param function returns the pixels written
+	 */
+	template <typename Function>
+	void same_on_every_isa(const char *name, Function &&function) {
+		kernel::limit_isa(kernel::Isa::scalar);
+		const std::vector<Uint32> expected = function();
+		for (const auto isa : isas) {
+			kernel::limit_isa(isa);
+			const bool same = function() == expected;
+			if (!same)
+				std::fprintf(stderr, "%s differs on instruction set %d\n", name, static_cast<int>(isa));
+			CHECK(same);
+		}
+		kernel::limit_isa(kernel::Isa::avx2);
+	}
+
+	// every source alpha and color over every destination color and alpha, against SDL_BlitSurface
+	void blend() {
+		auto src = make(256, 256), expected = make(256, 256), actual = make(256, 256);
+		for (int y = 0; y < 256; ++y)
+			for (Uint32 x = 0; x < 256; ++x)
+				src.row(y)[x] = static_cast<Uint32>(y) << 24 | x << 16 | (255 - x) << 8 | (x ^ 0x5a);
+		if (SDL_SetSurfaceBlendMode(src.get(), SDL_BLENDMODE_BLEND))
+			except::throw_exc();
+		int worst = 0;
+		for (Uint32 d = 0; d < 256; ++d) {
+			const Uint32 back = (d * 7 & 0xff) << 24 | d << 16 | (255 - d) << 8 | (d ^ 0xa5);
+			if (SDL_FillRect(expected.get(), nullptr, back) || SDL_BlitSurface(src.get(), nullptr, expected.get(), nullptr))
+				except::throw_exc();
+			std::vector<Uint32> scalar;
+			for (const auto isa : isas) {
+				kernel::limit_isa(isa);
+				std::vector<Uint32> result;
+				for (int y = 0; y < 256; ++y) {
+					kernel::fill(actual.row(y), 256, back);
+					kernel::blend(actual.row(y), src.row(y), 256);
+					result.insert(result.end(), actual.row(y), actual.row(y) + 256);
+				}
+				if (isa == kernel::Isa::scalar)
+					scalar = result;
+				else
+					CHECK(result == scalar);
+			}
+			for (int y = 0; y < 256; ++y)
+				for (int x = 0; x < 256; ++x) {
+					const int off = difference(scalar[static_cast<size_t>(y) * 256 + x], expected.row(y)[x]);
+					worst = std::max(worst, off);
+					// SDL copies opaque pixels and skips transparent ones, which the kernels do exactly
+					if (y == 0 || y == 255)
+						CHECK(off == 0);
+				}
+		}
+		kernel::limit_isa(kernel::Isa::avx2);
+		std::printf("blend: at most %d off SDL_BlitSurface per channel\n", worst);
+		CHECK(worst <= blend_tolerance);
+	}
+
+	// rectangles of every alignment against SDL_FillRect
+	void fill() {
+		auto expected = make(203, 61), actual = make(203, 61);
+		for (int i = 0; i < 200; ++i) {
+			randomize(expected);
+			std::memcpy(actual->pixels, expected->pixels, static_cast<size_t>(expected->pitch) * expected->h);
+			const SDL_Rect rect{static_cast<int>(generator() % 220) - 10, static_cast<int>(generator() % 70) - 5,
+			                    static_cast<int>(generator() % 120), static_cast<int>(generator() % 40)};
+			const SDL_Color color{static_cast<Uint8>(generator()), static_cast<Uint8>(generator()), static_cast<Uint8>(generator()), 255};
+			if (SDL_FillRect(expected.get(), &rect, expected.map_rgb(color)))
+				except::throw_exc();
+			actual.fill(color, rect);
+			CHECK(std::memcmp(actual->pixels, expected->pixels, static_cast<size_t>(expected->pitch) * expected->h) == 0);
+		}
+	}
+
+	// every pair of formats against SDL_ConvertSurfaceFormat
+	void convert() {
+		for (const Uint32 from : formats) {
+			auto src = make(67, 13, from);
+			randomize(src);
+			for (const Uint32 to : formats) {
+				SDL_Surface *expected = SDL_ConvertSurfaceFormat(src.get(), to, 0);
+				if (expected == nullptr)
+					except::throw_exc();
+				const surface::Surface reference(expected);
+				for (const auto isa : isas) {
+					kernel::limit_isa(isa);
+					const surface::Surface actual(src.convert(to));
+					for (int y = 0; y < src->h; ++y)
+						CHECK(std::memcmp(actual.row(y), reference.row(y), static_cast<size_t>(src->w) * 4) == 0);
+				}
+			}
+		}
+		kernel::limit_isa(kernel::Isa::avx2);
+	}
+
+	// every alpha and color against SDL_PremultiplyAlpha
+	void premultiply() {
+		auto src = make(256, 256), expected = make(256, 256);
+		for (int y = 0; y < 256; ++y)
+			for (Uint32 x = 0; x < 256; ++x)
+				src.row(y)[x] = static_cast<Uint32>(y) << 24 | x << 16 | (255 - x) << 8 | (x ^ 0x5a);
+		if (SDL_PremultiplyAlpha(256, 256, SDL_PIXELFORMAT_ARGB8888, src->pixels, src->pitch,
+		                         SDL_PIXELFORMAT_ARGB8888, expected->pixels, expected->pitch))
+			except::throw_exc();
+		int worst = 0;
+		same_on_every_isa("premultiply", [&] {
+			std::vector<Uint32> result;
+			for (int y = 0; y < 256; ++y) {
+				std::vector<Uint32> row(src.row(y), src.row(y) + 256);
+				kernel::premultiply(row.data(), row.size());
+				for (int x = 0; x < 256; ++x)
+					worst = std::max(worst, difference(row[x], expected.row(y)[x]));
+				result.insert(result.end(), row.begin(), row.end());
+			}
+			return result;
+		});
+		std::printf("premultiply: at most %d off SDL_PremultiplyAlpha per channel\n", worst);
+		CHECK(worst <= premultiply_tolerance);
+	}
+
+	// every alpha and color through premultiply and back, which loses at most half a step of the premultiplied color
+	void unpremultiply() {
+		std::vector<Uint32> pixels(256 * 256);
+		for (Uint32 a = 0; a < 256; ++a)
+			for (Uint32 c = 0; c < 256; ++c)
+				pixels[a * 256 + c] = a << 24 | c << 16 | (255 - c) << 8 | (c ^ 0x5a);
+		same_on_every_isa("unpremultiply", [&] {
+			std::vector<Uint32> result = pixels;
+			kernel::premultiply(result.data(), result.size());
+			kernel::unpremultiply(result.data(), result.size());
+			return result;
+		});
+		std::vector<Uint32> result = pixels;
+		kernel::premultiply(result.data(), result.size());
+		kernel::unpremultiply(result.data(), result.size());
+		for (Uint32 a = 0; a < 256; ++a) {
+			const int bound = a == 0 ? 255 : static_cast<int>((255 + 2 * a - 1) / (2 * a));
+			for (Uint32 c = 0; c < 256; ++c) {
+				const Uint32 original = pixels[a * 256 + c], back = result[a * 256 + c];
+				CHECK(difference(original, back) <= bound);
+				CHECK(back >> 24 == a);
+			}
+		}
+	}
+
+	// a source of another format is converted before blending, and clipped by the destination
+	void surface_blend() {
+		for (const auto mode : {kernel::Blend::straight, kernel::Blend::premultiplied, kernel::Blend::linear}) {
+			auto dst = make(40, 30), src = make(25, 20, SDL_PIXELFORMAT_ABGR8888);
+			randomize(dst);
+			randomize(src);
+			const pos::IPoint at(-5, 17);
+			SDL_Surface *converted = SDL_ConvertSurfaceFormat(src.get(), SDL_PIXELFORMAT_ARGB8888, 0);
+			if (converted == nullptr)
+				except::throw_exc();
+			const surface::Surface reference(converted);
+			std::vector<Uint32> expected(static_cast<size_t>(dst->w) * dst->h);
+			for (int y = 0; y < dst->h; ++y)
+				for (int x = 0; x < dst->w; ++x) {
+					Uint32 pixel = dst.row(y)[x];
+					const int sx = x - at.x, sy = y - at.y;
+					if (sx >= 0 && sy >= 0 && sx < src->w && sy < src->h)
+						kernel::blend(&pixel, reference.row(sy) + sx, 1, mode);
+					expected[static_cast<size_t>(y) * dst->w + x] = pixel;
+				}
+			dst.blend(src, at, mode);
+			for (int y = 0; y < dst->h; ++y)
+				CHECK(std::memcmp(dst.row(y), expected.data() + static_cast<size_t>(y) * dst->w, static_cast<size_t>(dst->w) * 4) == 0);
+		}
+	}
+
+	// the kernels without an SDL counterpart, on lengths that leave tails after the vector loops
+	void without_sdl() {
+		const size_t n = 1031;
+		const auto a = random_pixels(n * 2), b = random_pixels(n * 2);
+		same_on_every_isa("half", [&] {
+			std::vector<Uint32> result(n);
+			kernel::half(result.data(), a.data(), b.data(), n);
+			return result;
+		});
+		std::vector<int> xs(n), fxs(n);
+		for (size_t i = 0; i < n; ++i) {
+			xs[i] = static_cast<int>(generator() % (n - 1));
+			fxs[i] = static_cast<int>(generator() % 256);
+		}
+		same_on_every_isa("bilinear", [&] {
+			std::vector<Uint32> result(n);
+			kernel::bilinear(result.data(), a.data(), b.data(), 77, xs.data(), fxs.data(), n);
+			return result;
+		});
+		same_on_every_isa("dim", [&] {
+			std::vector<Uint32> result(a.begin(), a.begin() + n);
+			kernel::dim(result.data(), n, -37, 0xff000000);
+			return result;
+		});
+		same_on_every_isa("merge", [&] {
+			std::vector<Uint32> result(n);
+			kernel::merge(result.data(), a.data(), b.data(), n);
+			return result;
+		});
+		same_on_every_isa("blend premultiplied", [&] {
+			std::vector<Uint32> dst(a.begin(), a.begin() + n), src(b.begin(), b.begin() + n);
+			kernel::premultiply(dst.data(), n);
+			kernel::premultiply(src.data(), n);
+			kernel::blend_premultiplied(dst.data(), src.data(), n);
+			return dst;
+		});
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		blend();
+		fill();
+		convert();
+		premultiply();
+		unpremultiply();
+		surface_blend();
+		without_sdl();
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return check::finish("kernel");
+}
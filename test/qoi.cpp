@@ -0,0 +1,145 @@
+#include "../image/qoi.hpp"
+#include "check.hpp"
+#include <random>
+#include <vector>
+#include <cstring>
+
+#undef main
+
+// Round-trips images through encode_qoi and decode_qoi, and checks that broken data is rejected.
+using namespace leap;
+
+namespace {
+	std::mt19937 generator(13);
+
+	surface::Surface make(int w, int h, Uint32 format = SDL_PIXELFORMAT_RGBA32) {
+		SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, format);
+		if (surface == nullptr)
+			except::throw_exc();
+		return surface::Surface(surface);
+	}
+
+	/**
+	 * \brief an image that takes every kind of chunk: runs longer than one chunk holds, repeats found in the index,
+	 * small and medium steps, and jumps of color and of alpha
+	 */
+	surface::Surface every_chunk(int w, int h) {
+		auto image = make(w, h);
+		for (int y = 0; y < h; ++y) {
+			auto *row = reinterpret_cast<Uint8 *>(image.row(y));
+			for (int x = 0; x < w; ++x) {
+				Uint8 *px = row + x * 4;
+				switch (y % 5) {
+					case 0: // runs
+						px[0] = px[1] = px[2] = static_cast<Uint8>(x / 100 * 40);
+						px[3] = 255;
+						break;
+					case 1: // repeats of a few colors
+						px[0] = static_cast<Uint8>(x % 3 * 80);
+						px[1] = static_cast<Uint8>(x % 4 * 60);
+						px[2] = 30;
+						px[3] = 255;
+						break;
+					case 2: // steps of -2 to 1, and of up to 31 in green
+						px[0] = static_cast<Uint8>(x);
+						px[1] = static_cast<Uint8>(x * (x % 2 ? 1 : 20));
+						px[2] = static_cast<Uint8>(-x);
+						px[3] = 255;
+						break;
+					default: // noise, with alpha changing in every other row
+						const Uint32 noise = generator();
+						std::memcpy(px, &noise, 3);
+						px[3] = y % 5 == 3 ? 255 : static_cast<Uint8>(noise >> 24);
+				}
+			}
+		}
+		return image;
+	}
+
+	bool same_pixels(const surface::Surface &a, const surface::Surface &b) {
+		if (a->w != b->w || a->h != b->h || a->format->format != b->format->format)
+			return false;
+		for (int y = 0; y < a->h; ++y)
+			if (std::memcmp(a.row(y), b.row(y), static_cast<size_t>(a->w) * 4) != 0)
+				return false;
+		return true;
+	}
+
+	void round_trip() {
+		for (const auto &[w, h] : {std::pair{1, 1}, {7, 3}, {333, 50}, {1024, 20}}) {
+			const auto image = every_chunk(w, h);
+			const auto data = image::encode_qoi(image);
+			CHECK(std::to_integer<int>(data[12]) == 4);
+			CHECK(same_pixels(*image::decode_qoi(data), image));
+		}
+	}
+
+	// a surface without alpha is stored with 3 channels, and comes back opaque
+	void without_alpha() {
+		auto image = make(97, 31, SDL_PIXELFORMAT_RGB888);
+		for (int y = 0; y < image->h; ++y)
+			for (int x = 0; x < image->w; ++x)
+				image.row(y)[x] = x < 40 ? 0x102030 : generator() & 0xffffff;
+		const auto data = image::encode_qoi(image);
+		CHECK(std::to_integer<int>(data[12]) == 3);
+		const auto decoded = image::decode_qoi(data);
+		SDL_Surface *expected = SDL_ConvertSurfaceFormat(image.get(), SDL_PIXELFORMAT_RGBA32, 0);
+		if (expected == nullptr)
+			except::throw_exc();
+		CHECK(same_pixels(*decoded, surface::Surface(expected)));
+	}
+
+	// one opaque black pixel is the starting pixel of the format, so it encodes as a run of one
+	void known_bytes() {
+		auto image = make(1, 1);
+		image.row(0)[0] = 0;
+		reinterpret_cast<Uint8 *>(image.row(0))[3] = 255;
+		const auto data = image::encode_qoi(image);
+		const Uint8 expected[] = {'q', 'o', 'i', 'f', 0, 0, 0, 1, 0, 0, 0, 1, 4, 0, 0xc0, 0, 0, 0, 0, 0, 0, 0, 1};
+		CHECK(data.size() == sizeof(expected));
+		CHECK(data.size() == sizeof(expected) && std::memcmp(data.data(), expected, sizeof(expected)) == 0);
+	}
+
+	template <typename Function>
+	bool throws(Function &&function) {
+		try {
+			function();
+		}
+		catch (const except::LeapException &) {
+			return true;
+		}
+		return false;
+	}
+
+	void broken() {
+		const auto data = image::encode_qoi(every_chunk(64, 10));
+		const std::span<const std::byte> bytes(data);
+		// cut in the middle of the chunks, which keeps a full end marker in the data
+		CHECK(throws([&] { image::decode_qoi(bytes.first(data.size() / 2)); }));
+		CHECK(throws([&] { image::decode_qoi(bytes.first(10)); }));
+
+		auto header = data;
+		header[0] = std::byte{'Q'};
+		CHECK(throws([&] { image::decode_qoi(header); }));
+		header = data;
+		header[12] = std::byte{5};
+		CHECK(throws([&] { image::decode_qoi(header); }));
+		header = data;
+		std::fill(header.begin() + 4, header.begin() + 12, std::byte{0xff});
+		CHECK(throws([&] { image::decode_qoi(header); }));
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		round_trip();
+		without_alpha();
+		known_bytes();
+		broken();
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return check::finish("qoi");
+}
@@ -0,0 +1,142 @@
+#include "../sdl/sdl_packs.h"
+#include "check.hpp"
+#include <bitset>
+#include <random>
+#include <vector>
+
+#undef main
+
+// Checks Region against a model that keeps one bit per pixel, on random rectangles in a small grid.
+using namespace leap;
+
+namespace {
+	constexpr int side = 48, cases = 3000;
+	using Pixels = std::bitset<side * side>;
+
+	std::mt19937 generator(20);
+
+	int random(int below) {
+		return static_cast<int>(generator() % static_cast<unsigned>(below));
+	}
+
+	// rectangles that may stick out of the grid, and may be empty
+	pos::IRect random_rect() {
+		return {random(side + 8) - 4, random(side + 8) - 4, random(side / 2), random(side / 2)};
+	}
+
+	std::vector<pos::IRect> random_rects() {
+		std::vector<pos::IRect> rects(static_cast<size_t>(1 + random(8)));
+		for (auto &rect : rects)
+			rect = random_rect();
+		return rects;
+	}
+
+	void paint(Pixels &pixels, const pos::IRect &rect) {
+		for (int y = std::max(rect.y, 0); y < std::min(rect.y + rect.h, side); ++y)
+			for (int x = std::max(rect.x, 0); x < std::min(rect.x + rect.w, side); ++x)
+				pixels.set(static_cast<size_t>(y * side + x));
+	}
+
+	Pixels model(const std::vector<pos::IRect> &rects) {
+		Pixels pixels;
+		for (const auto &rect : rects)
+			paint(pixels, rect);
+		return pixels;
+	}
+
+	// the grid is a window on the region, so results are compared inside of it
+	const Pixels &grid() {
+		static const Pixels pixels = model({{0, 0, side, side}});
+		return pixels;
+	}
+
+	Pixels pixels_of(const pos::Region &region) {
+		return model(region.rects()) & grid();
+	}
+
+	// the rectangles are sorted by y then x, the bands do not overlap, and the rectangles of a band do not touch
+	bool well_formed(const pos::Region &region) {
+		const auto &rects = region.rects();
+		long long area = 0;
+		for (size_t i = 0; i < rects.size(); ++i) {
+			const auto &rect = rects[i];
+			if (rect.empty())
+				return false;
+			area += static_cast<long long>(rect.w) * rect.h;
+			if (i > 0) {
+				const auto &previous = rects[i - 1];
+				if (previous.y == rect.y) {
+					if (previous.h != rect.h || previous.x + previous.w >= rect.x)
+						return false;
+				}
+				else if (previous.y + previous.h > rect.y)
+					return false;
+			}
+		}
+		return area == region.area();
+	}
+
+	pos::Region clipped(const pos::Region &region) {
+		return region & pos::Region(pos::IRect(0, 0, side, side));
+	}
+
+	void operations() {
+		for (int i = 0; i < cases; ++i) {
+			const auto a = random_rects(), b = random_rects();
+			const pos::Region ra(a), rb(b);
+			const Pixels ma = model(a) & grid(), mb = model(b) & grid();
+			CHECK(well_formed(ra));
+			CHECK(pixels_of(ra) == ma);
+
+			const pos::Region united = ra | rb, both = ra & rb, left = ra - rb, either = ra ^ rb;
+			CHECK(well_formed(united) && well_formed(both) && well_formed(left) && well_formed(either));
+			CHECK(pixels_of(united) == (ma | mb));
+			CHECK(pixels_of(both) == (ma & mb));
+			CHECK(pixels_of(left) == (ma & ~mb));
+			CHECK(pixels_of(either) == (ma ^ mb));
+
+			// one set has one representation, however it was built
+			CHECK(clipped(united) == clipped(rb | ra));
+			CHECK(clipped(either) == clipped((ra - rb) | (rb - ra)));
+			pos::Region built;
+			for (const auto &rect : a)
+				built |= pos::Region(rect);
+			CHECK(built == ra);
+
+			CHECK(ra.bounds().empty() == ra.empty());
+			const auto bounds = ra.bounds();
+			for (const auto &rect : ra)
+				CHECK(bounds.x <= rect.x && bounds.y <= rect.y &&
+				      rect.x + rect.w <= bounds.x + bounds.w && rect.y + rect.h <= bounds.y + bounds.h);
+		}
+	}
+
+	void queries() {
+		for (int i = 0; i < cases; ++i) {
+			const auto a = random_rects();
+			const pos::Region region(a);
+			const Pixels pixels = model(a) & grid();
+			for (int j = 0; j < 16; ++j) {
+				const pos::IPoint point(random(side), random(side));
+				CHECK(region.contains(point) == pixels.test(static_cast<size_t>(point.y * side + point.x)));
+			}
+			auto rect = random_rect();
+			rect = rect.intersection(pos::IRect(0, 0, side, side));
+			const Pixels covered = model({rect});
+			CHECK(region.intersects(rect) == (pixels & covered).any());
+			CHECK(region.covers(rect) == (!rect.empty() && (pixels & covered) == covered));
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		operations();
+		queries();
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return check::finish("region");
+}
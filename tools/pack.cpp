@@ -0,0 +1,30 @@
+#include "../sdl/pack.hpp"
+#include <iostream>
+#include <filesystem>
+
+#undef main
+
+// Builds an asset pack from every file under a directory, named by their paths relative to it with '/'.
+// usage: leap-pack <output> <directory>
+int main(int argc, char **argv) {
+	if (argc != 3) {
+		std::cerr << "usage: " << argv[0] << " <output> <directory>\n";
+		return 1;
+	}
+	namespace fs = std::filesystem;
+	try {
+		const fs::path root(argv[2]);
+		leap::pack::PackWriter writer;
+		for (const auto &entry : fs::recursive_directory_iterator(root)) {
+			if (entry.is_regular_file())
+				writer.add_file(fs::relative(entry.path(), root).generic_string(), entry.path().string());
+		}
+		writer.write(argv[1]);
+		std::cout << "packed " << writer.size() << " files into " << argv[1] << "\n";
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
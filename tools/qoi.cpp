@@ -0,0 +1,26 @@
+#include "../image/image.hpp"
+#include <iostream>
+
+#undef main
+
+// Converts an image between QOI and any format SDL_image reads, the output is QOI or PNG by its extension.
+// usage: leap-qoi <input> <output>
+int main(int argc, char **argv) {
+	if (argc != 3) {
+		std::cerr << "usage: " << argv[0] << " <input> <output>\n";
+		return 1;
+	}
+	try {
+		leap::image::init(IMG_INIT_PNG);
+		const auto image = leap::image::load(argv[1]);
+		if (leap::image::is_qoi(argv[2]))
+			leap::image::save_qoi(*image, argv[2]);
+		else if (IMG_SavePNG(image->get(), argv[2]))
+			leap::except::throw_exc();
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
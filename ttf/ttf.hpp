@@ -10,6 +10,8 @@ namespace leap {
 	namespace ttf {
 		class Font {
 			TTF_Font *font_;
+			// the pack the font is read from lazily, kept open as long as the font
+			std::shared_ptr<const pack::Pack> pack_;
 
 			static pointer::SurfacePtr check(SDL_Surface *surface) {
 				if (surface == nullptr)
@@ -24,6 +26,30 @@ namespace leap {
 					except::throw_exc();
 			}
 
+			/**
+			 * \param rw the stream to read the font from, which is closed by the font
+			 * \param size the point size
+			 */
+			Font(SDL_RWops *rw, int size) {
+				font_ = TTF_OpenFontRW(rw, 1, size);
+				if (font_ == nullptr)
+					except::throw_exc();
+			}
+
+			/**
+			 * \brief opens a font stored in an asset pack, which is read in place and must outlive the font
+			 */
+			Font(const pack::Pack &pack, std::string_view name, int size) :
+				Font(pack.open(name), size) {}
+
+			/**
+			 * \brief opens a font stored in an asset pack, which the font keeps alive
+			 */
+			Font(std::shared_ptr<const pack::Pack> pack, std::string_view name, int size) :
+				Font(*pack, name, size) {
+				pack_ = std::move(pack);
+			}
+
 			~Font() noexcept {
 				TTF_CloseFont(font_);
 			}
@@ -59,10 +85,13 @@ namespace leap {
 
 		class FontFamily {
 			std::string path_;
+			// set when path_ names an entry of a pack instead of a file
+			std::shared_ptr<const pack::Pack> pack_;
 			std::unordered_map<int, FontPtr> fonts_;
 
 			FontPtr add(int size) {
-				auto ptr = std::make_shared<Font>(path_.c_str(), size);
+				auto ptr = pack_ ? std::make_shared<Font>(pack_, path_, size)
+				                 : std::make_shared<Font>(path_.c_str(), size);
 				fonts_.emplace(size, ptr);
 				return ptr;
 			}
@@ -74,6 +103,13 @@ namespace leap {
 		public:
 			explicit FontFamily(std::string path) : path_(std::move(path)) {}
 
+			/**
+			 * \param pack the pack storing the font, kept alive by the family and the fonts it returns
+			 * \param name the name of the font in the pack
+			 */
+			FontFamily(std::shared_ptr<const pack::Pack> pack, std::string name) :
+				path_(std::move(name)), pack_(std::move(pack)) {}
+
 			FontPtr at(int size) {
 				try {
 					return get(size);
@@ -2,6 +2,8 @@
 
 #include "const.h"
 #include <memory>
+#include <vector>
+#include <functional>
 
 namespace leap {
 	namespace widget {
@@ -25,6 +27,27 @@ namespace leap {
 		};
 
 		class Widget {
+			std::vector<pos::IRect> invalid_;
+			std::function<void()> invalidate_handler_;
+
+		protected:
+			/**
+			 * \brief marks a part of the screen as needing a redraw
+			 * \param rect the area that changed
+			 */
+			void invalidate(const pos::IRect &rect) {
+				invalid_.push_back(rect);
+				notify_invalidated();
+			}
+
+			/**
+			 * \brief tells the container of the widget that it has areas to redraw
+			 */
+			void notify_invalidated() const {
+				if (invalidate_handler_)
+					invalidate_handler_();
+			}
+
 		public:
 			Widget() = default;
 
@@ -34,6 +57,36 @@ namespace leap {
 
 			virtual void update() = 0;
 
+			/**
+			 * \brief the area the widget draws in
+			 * \return the bounding rectangle, or an empty rectangle if the widget may draw anywhere
+			 */
+			virtual pos::IRect bounds() const noexcept {
+				return {};
+			}
+
+			/**
+			 * \brief moves the areas invalidated since the last call into \c damage
+			 * \param damage the damage to report to
+			 */
+			void collect_damage(damage::Damage &damage) {
+				for (const auto &rect : invalid_)
+					damage.add(rect);
+				invalid_.clear();
+			}
+
+			bool is_invalid() const noexcept {
+				return !invalid_.empty();
+			}
+
+			/**
+			 * \brief sets what is called whenever the widget invalidates an area, so that a change made outside of
+			 * a frame, e.g. by a timer or a background job, gets one drawn. Set by the canvas or layer holding it
+			 */
+			void set_invalidate_handler(std::function<void()> handler) {
+				invalidate_handler_ = std::move(handler);
+			}
+
 			/**
 			 * \brief access to the status of the widget
 			 * \return the pointer to the status(may be \c nullptr)
@@ -36,6 +36,7 @@ namespace leap {
 				}
 
 				void update() override {
+					const bool was_active = status_.is_active, was_pressed = status_.is_pressed;
 					status_.is_clicked = false;
 
 					status_.is_active = detector_(status_);
@@ -61,7 +62,9 @@ namespace leap {
 						status_.clicked_sign_ = false;
 						status_.is_clicked = false;
 					}
-						
+
+					if (was_active != status_.is_active || was_pressed != status_.is_pressed)
+						invalidate(status_.range);
 				}
 
 				void draw(const render::Renderer &renderer) override {
@@ -76,12 +79,20 @@ namespace leap {
 					return status_;
 				}
 
+				pos::IRect bounds() const noexcept override {
+					return status_.range;
+				}
+
 				void move_to(const pos::IPoint &position) {
+					invalidate(status_.range);
 					status_.range.move_to(position);
+					invalidate(status_.range);
 				}
 
 				void resize(const pos::IRect &range) {
+					invalidate(status_.range);
 					status_.range = range;
+					invalidate(status_.range);
 				}
 
 				const pos::IRect &range() const noexcept {
@@ -96,6 +107,79 @@ namespace leap {
 					};
 				}
 
+				/**
+				 * \brief Finds the rectangle under the mouse in a spatial::Grid, once for each change of the mouse
+				 * position or of the grid, however many detectors ask.
+				 */
+				class HitTest {
+					pointer::MousePtr mouse_;
+					pointer::GridPtr grid_;
+					mutable pos::IPoint position_;
+					mutable size_t version_ = 0;
+					mutable spatial::Grid::Id hovered_ = spatial::Grid::none;
+					mutable bool valid_ = false;
+
+				public:
+					explicit HitTest(pointer::MousePtr mouse, pointer::GridPtr grid = pointer::make_grid()) noexcept :
+						mouse_(std::move(mouse)), grid_(std::move(grid)) {}
+
+					const pointer::GridPtr &grid() const noexcept {
+						return grid_;
+					}
+
+					/**
+					 * \return the topmost rectangle under the mouse, or spatial::Grid::none
+					 */
+					spatial::Grid::Id hovered() const {
+						const auto position = mouse_->get_position();
+						if (!valid_ || position.x != position_.x || position.y != position_.y || version_ != grid_->version()) {
+							hovered_ = grid_->hit(position);
+							position_ = position;
+							version_ = grid_->version();
+							valid_ = true;
+						}
+						return hovered_;
+					}
+				};
+
+				using HitTestPtr = std::shared_ptr<HitTest>;
+
+				template <typename... Types>
+				HitTestPtr make_hit_test(Types &&... args) {
+					return std::make_shared<HitTest>(std::forward<Types>(args)...);
+				}
+
+				/**
+				 * \brief makes a detector that looks the mouse up in the grid of \c hit_test instead of checking
+				 * the range itself, so that a frame of many buttons costs one lookup
+				 * \details the range is added to the grid now, followed when the button moves or resizes, and
+				 * removed with the detector. Of overlapping buttons only the last added is active
+				 * \param range the range of the button
+				 */
+				inline Button::detector make_detector(const HitTestPtr &hit_test, const pos::IRect &range) {
+					struct Entry {
+						pointer::GridPtr grid;
+						spatial::Grid::Id id;
+
+						Entry(pointer::GridPtr grid, const pos::IRect &range) :
+							grid(std::move(grid)), id(this->grid->insert(range)) {}
+
+						Entry(const Entry &) = delete;
+
+						~Entry() {
+							grid->remove(id);
+						}
+					};
+					const auto entry = std::make_shared<Entry>(hit_test->grid(), range);
+					return [hit_test, entry](const Button::StatusType &status) -> bool {
+						const auto &indexed = entry->grid->rect(entry->id);
+						if (indexed.x != status.range.x || indexed.y != status.range.y ||
+						    indexed.w != status.range.w || indexed.h != status.range.h)
+							entry->grid->move(entry->id, status.range);
+						return hit_test->hovered() == entry->id;
+					};
+				}
+
 				inline Button::clicker make_clicker(const pointer::MousePtr &mouse) {
 					return [mouse](const Button::StatusType &status) -> bool {
 						return mouse->pressed(input::mouse::left);
@@ -129,6 +213,27 @@ namespace leap {
 				return std::make_shared<Style>(Style{back, front, on_press});
 			}
 
+			/**
+			 * \brief draws a part of the style on a new surface, see make_style_bit for the parameters
+			 */
+			inline pointer::SurfacePtr make_style_surface(const SDL_Color &back_color, const SDL_Color &front_color,
+			                                              const pointer::SurfacePtr &image,
+			                                              const pos::IPoint &size, const int outline) {
+				pos::Rect front_rect(0, 0, size.x, size.y);
+				front_rect = front_rect.shrink(outline);
+
+				auto surface = pointer::make_surface(size);
+				surface->fill(back_color);
+				surface->fill(front_color, front_rect);
+
+				if (image.get()) {
+					pos::Rect image_rect = image->get_range().centered(front_rect);
+					surface->blit(*image, image_rect);
+				}
+
+				return surface;
+			}
+
 			/**
 			 * \brief makes a part of the style texture using the format provided
 			 * \param renderer the renderer required to convert surface to texture
@@ -143,19 +248,20 @@ namespace leap {
 			                                          const SDL_Color &back_color, const SDL_Color &front_color,
 			                                          const pointer::SurfacePtr &image,
 			                                          const pos::IPoint &size, const int outline) {
-				pos::Rect front_rect(0, 0, size.x, size.y);
-				front_rect = front_rect.shrink(outline);
-
-				const surface::Surface surface(size);
-				surface.fill(back_color);
-				surface.fill(front_color, front_rect);
-
-				if (image.get()) {
-					pos::Rect image_rect = image->get_range().centered(front_rect);
-					surface.blit(*image, image_rect);
-				}
+				return pointer::make_texture(
+					renderer.convert(*make_style_surface(back_color, front_color, image, size, outline)));
+			}
 
-				return pointer::make_texture(renderer.convert(surface));
+			/**
+			 * \brief makes a part of the style texture inside of an atlas, so that styles share one texture
+			 * \param atlas the atlas to pack the style into
+			 * \return a sub texture of the atlas
+			 */
+			inline pointer::TexturePtr make_style_bit(atlas::Atlas &atlas,
+			                                          const SDL_Color &back_color, const SDL_Color &front_color,
+			                                          const pointer::SurfacePtr &image,
+			                                          const pos::IPoint &size, const int outline) {
+				return atlas.add(make_style_surface(back_color, front_color, image, size, outline));
 			}
 		}
 	}
@@ -163,6 +269,8 @@ namespace leap {
 	namespace pointer {
 		namespace button {
 			using widget::button::StylePtr;
+			using widget::button::mouse::HitTestPtr;
+			using widget::button::mouse::make_hit_test;
 		}
 	}
 }
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "const.h"
+#include "base.hpp"
+#include <vector>
+#include <algorithm>
+
+namespace leap {
+	namespace widget {
+		namespace canvas {
+			/**
+			 * \brief Draws widgets into a persistent target texture, and redraws only the damaged areas.
+			 * \details Each damaged rectangle is filled with the background, and every widget overlapping it
+			 * is drawn again with the rectangle as the clip. Widgets must draw inside of their bounds,
+			 * and the background should be opaque, since it is drawn with the current blend mode.
+			 * A handler set by set_invalidate_handler hears of damage added between frames, to ask the run loop
+			 * for a redraw.
+			 */
+			class Canvas {
+				const render::Renderer &renderer_;
+				pointer::TexturePtr target_;
+				pos::IRect range_;
+				color::Color background_;
+				std::vector<Widget *> widgets_;
+				damage::Damage damage_;
+				std::function<void()> invalidate_handler_;
+				// damage found by update is drawn in the same frame, so it is not reported
+				bool updating_ = false;
+
+				void notify() const {
+					if (!updating_ && invalidate_handler_)
+						invalidate_handler_();
+				}
+
+			public:
+				/**
+				 * \param renderer the renderer to draw with, which must outlive the canvas
+				 * \param size the size of the target, usually the logical size of the renderer
+				 * \param background the color of the area not covered by widgets
+				 */
+				Canvas(const render::Renderer &renderer, const pos::IPoint &size, const color::Color &background) :
+					renderer_(renderer),
+					target_(pointer::make_texture(
+						renderer.create_texture(SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, size))),
+					range_(0, 0, size.x, size.y), background_(background) {
+					target_->set_blend_mode(SDL_BLENDMODE_NONE);
+					damage_.add(range_);
+				}
+
+				Canvas(const Canvas &) = delete;
+
+				~Canvas() {
+					for (auto widget : widgets_)
+						widget->set_invalidate_handler(nullptr);
+				}
+
+				/**
+				 * \brief sets what is called when damage is added outside of update, e.g. Loop::request_redraw
+				 */
+				void set_invalidate_handler(std::function<void()> handler) {
+					invalidate_handler_ = std::move(handler);
+				}
+
+				/**
+				 * \brief adds a widget to be updated and drawn by the canvas, widgets are drawn in the order added
+				 * \param widget the widget, which must outlive the canvas or be removed first
+				 */
+				void add(Widget &widget) {
+					widgets_.push_back(&widget);
+					widget.set_invalidate_handler([this] { notify(); });
+					invalidate(widget.bounds().empty() ? range_ : widget.bounds());
+				}
+
+				void remove(Widget &widget) {
+					const auto it = std::find(widgets_.begin(), widgets_.end(), &widget);
+					if (it != widgets_.end()) {
+						invalidate(widget.bounds().empty() ? range_ : widget.bounds());
+						widget.set_invalidate_handler(nullptr);
+						widgets_.erase(it);
+					}
+				}
+
+				void invalidate(const pos::IRect &rect) {
+					damage_.add(rect.intersection(range_));
+					notify();
+				}
+
+				/**
+				 * \brief marks the whole canvas as damaged, e.g. after the window is exposed
+				 */
+				void invalidate() {
+					damage_.add(range_);
+					notify();
+				}
+
+				/**
+				 * \brief updates every widget and collects the areas they invalidated
+				 */
+				void update() {
+					updating_ = true;
+					try {
+						for (auto widget : widgets_) {
+							widget->update();
+							widget->collect_damage(damage_);
+						}
+					}
+					catch (...) {
+						updating_ = false;
+						throw;
+					}
+					updating_ = false;
+				}
+
+				/**
+				 * \brief redraws the damaged areas and copies the target to the window
+				 * \return whether anything was drawn, so the caller only presents when needed
+				 */
+				bool draw() {
+					if (damage_.empty())
+						return false;
+
+					renderer_.set_target(target_->get());
+					for (const auto &rect : damage_.rects()) {
+						renderer_.set_clip(rect);
+						renderer_.set_color(background_);
+						renderer_.fill_rect(rect);
+						for (auto widget : widgets_) {
+							const auto bounds = widget->bounds();
+							if (bounds.empty() || bounds.intersects(rect))
+								widget->draw(renderer_);
+						}
+					}
+					renderer_.reset_clip();
+					renderer_.reset_target();
+
+					renderer_.copy(target_->get());
+					damage_.clear();
+					return true;
+				}
+
+				const damage::Damage &get_damage() const noexcept {
+					return damage_;
+				}
+
+				const pointer::TexturePtr &get_target() const noexcept {
+					return target_;
+				}
+			};
+		}
+	}
+}
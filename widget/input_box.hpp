@@ -38,20 +38,23 @@ namespace leap {
 
 				StatusType status_;
 
-				void feed_input(int input) {
+				/**
+				 * \return whether the text has changed
+				 */
+				bool feed_input(int input) {
 					switch (input) {
 					case -1:
 					case 0:
-						break;
+						return false;
 					case '\b':
 						if (!chars_.empty()) {
 							status_.cursor = chars_.erase(--status_.cursor);
+							return true;
 						}
-						break;
+						return false;
 					default:
 						status_.cursor = ++chars_.insert(status_.cursor, input);
-
-						break;
+						return true;
 					}
 				}
 
@@ -69,13 +72,23 @@ namespace leap {
 				}
 
 				void update() override {
+					bool changed = false;
 					if (focus_changer_(status_)) {
 						status_.focused = !status_.focused;
+						changed = true;
 					}
 					if (status_.focused) {
+						const auto cursor = status_.cursor;
 						cursor_mover_(status_, status_.cursor);
-						feed_input(inputer_(status_, status_.shift));
+						changed |= cursor != status_.cursor;
+						changed |= feed_input(inputer_(status_, status_.shift));
 					}
+					if (changed)
+						invalidate(status_.range);
+				}
+
+				pos::IRect bounds() const noexcept override {
+					return status_.range;
 				}
 
 				StatusPtr status() const noexcept override {
@@ -87,7 +100,9 @@ namespace leap {
 				}
 
 				void move_to(const pos::IPoint &pos) {
+					invalidate(status_.range);
 					status_.range.move_to(pos);
+					invalidate(status_.range);
 				}
 			};
 
@@ -235,14 +250,25 @@ namespace leap {
 				};
 			}
 
+			/**
+			 * \brief makes a drawer rendering the text with \c font, which renders again only when the text changes
+			 */
 			inline InputBox::text_drawer make_text_drawer(const pointer::FontPtr &font, const SDL_Color &color) {
-				return [font, color](const render::Renderer &renderer, const InputBox::StatusType &status) {
+				struct Cache {
+					std::string text;
+					pointer::TexturePtr texture;
+				};
+				return [font, color, cache = std::make_shared<Cache>()](const render::Renderer &renderer,
+				                                                        const InputBox::StatusType &status) {
 					if (!status.chars.empty()) {
 						std::string str{status.chars.begin(), status.chars.end()};
 						str.insert(std::distance(status.chars.begin(), status.cursor), "|");
-						const auto surface = font->render_blended_wrapped(str, color);
-						const auto texture = pointer::make_texture(renderer.convert(*surface));
-						texture->copy_to(renderer, status.range.left_up());
+						if (!cache->texture || cache->text != str) {
+							const auto surface = font->render_blended_wrapped(str, color);
+							cache->texture = pointer::make_texture(renderer.convert(*surface));
+							cache->text = std::move(str);
+						}
+						cache->texture->copy_to(renderer, status.range.left_up());
 					}
 				};
 			}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "const.h"
+#include "base.hpp"
+#include <vector>
+#include <algorithm>
+
+namespace leap {
+	namespace widget {
+		namespace layer {
+			/**
+			 * \brief Caches a group of widgets in a target texture, which is presented with a single copy.
+			 * \details Children keep their screen coordinates, so detectors work as before. They are drawn again
+			 * only where they invalidated themselves, and the layer reports those areas to its own parent.
+			 * Children should draw inside of the layer range, since nothing outside of it is cached.
+			 */
+			class Layer : public Widget {
+				pointer::TexturePtr texture_;
+				pos::IRect range_;
+				color::Color background_;
+				std::vector<Widget *> children_;
+				damage::Damage damage_, child_damage_;
+
+				void render(const render::Renderer &renderer) {
+					const SDL_BlendMode blend = renderer.get_blend_mode();
+					const render::TargetScope scope(renderer, texture_->get());
+					// the viewport stays at (0, 0), the offset lets children draw in screen coordinates
+					const render::OffsetScope offset(renderer, pos::IPoint(-range_.x, -range_.y));
+					renderer.reset_viewport();
+					for (const auto &rect : damage_.rects()) {
+						renderer.set_clip(rect);
+						renderer.set_blend_mode(SDL_BLENDMODE_NONE);
+						renderer.set_color(background_);
+						renderer.fill_rect(rect);
+						renderer.set_blend_mode(blend);
+						for (auto child : children_) {
+							const auto bounds = child->bounds();
+							if (bounds.empty() || bounds.intersects(rect))
+								child->draw(renderer);
+						}
+					}
+					damage_.clear();
+				}
+
+			public:
+				/**
+				 * \param renderer the renderer used to create the layer texture
+				 * \param range where the layer is presented, in screen coordinates
+				 * \param background the color the layer is cleared to, transparent by default
+				 */
+				Layer(const render::Renderer &renderer, const pos::IRect &range,
+				      const color::Color &background = {0, 0, 0, 0}) :
+					texture_(pointer::make_texture(
+						renderer.create_texture(SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, range.size()))),
+					range_(range), background_(background) {
+					texture_->set_blend_mode(SDL_BLENDMODE_BLEND);
+					invalidate_all();
+				}
+
+				Layer(const Layer &) = delete;
+
+				~Layer() override {
+					for (auto child : children_)
+						child->set_invalidate_handler(nullptr);
+				}
+
+				/**
+				 * \brief adds a child, children are drawn in the order added
+				 * \param widget the child, which must outlive the layer or be removed first
+				 */
+				void add(Widget &widget) {
+					children_.push_back(&widget);
+					widget.set_invalidate_handler([this] { notify_invalidated(); });
+					invalidate_all();
+				}
+
+				void remove(Widget &widget) {
+					const auto it = std::find(children_.begin(), children_.end(), &widget);
+					if (it != children_.end()) {
+						(*it)->set_invalidate_handler(nullptr);
+						children_.erase(it);
+						invalidate_all();
+					}
+				}
+
+				/**
+				 * \brief drops the cached content, so the whole layer is rendered again at the next draw
+				 */
+				void invalidate_all() {
+					damage_.clear();
+					damage_.add(range_);
+					invalidate(range_);
+				}
+
+				void update() override {
+					for (auto child : children_) {
+						child->update();
+						if (child->is_invalid()) {
+							child_damage_.clear();
+							child->collect_damage(child_damage_);
+							for (const auto &rect : child_damage_.rects()) {
+								const auto clipped = rect.intersection(range_);
+								damage_.add(clipped);
+								invalidate(clipped);
+							}
+						}
+					}
+				}
+
+				void draw(const render::Renderer &renderer) override {
+					if (!damage_.empty())
+						render(renderer);
+					texture_->copy_to(renderer, range_);
+				}
+
+				pos::IRect bounds() const noexcept override {
+					return range_;
+				}
+
+				const pointer::TexturePtr &get_texture() const noexcept {
+					return texture_;
+				}
+			};
+		}
+	}
+}
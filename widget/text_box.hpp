@@ -41,6 +41,17 @@ namespace leap {
 
 				TextList text_;
 				TextureList texture_;
+				pos::IRect bounds_;
+
+				static pos::IRect range_of(const TextureList::value_type &texture) noexcept {
+					return texture.second->query_range() + texture.first;
+				}
+
+				void update_bounds() noexcept {
+					bounds_ = {};
+					for (const auto &texture : texture_)
+						bounds_ = bounds_.united(range_of(texture));
+				}
 
 			public:
 				TextBox(formatter formatter, convertor convertor) :
@@ -55,6 +66,10 @@ namespace leap {
 
 				void update() override { }
 
+				pos::IRect bounds() const noexcept override {
+					return bounds_;
+				}
+
 				/**
 				 * \brief adds a new text to the text box, and returns the texture instance
 				 * \param renderer the renderer used
@@ -67,6 +82,8 @@ namespace leap {
 					auto texture = convertor_(renderer, text);
 					text_.push_back(text);
 					texture_.push_back(std::make_pair(position, texture));
+					invalidate(range_of(texture_.back()));
+					bounds_ = bounds_.united(range_of(texture_.back()));
 					return texture;
 				}
 
@@ -77,11 +94,14 @@ namespace leap {
 				 * \param texture_it the iterator of texture to be modified
 				 * \return a pointer to the texture instance created
 				 */
-				pointer::TexturePtr modify(const render::Renderer& renderer, const TextList::iterator &text_it, const TextureList::iterator &texture_it) const {
+				pointer::TexturePtr modify(const render::Renderer& renderer, const TextList::iterator &text_it, const TextureList::iterator &texture_it) {
 					auto text = formatter_((*text_it)->value);
 					auto texture = convertor_(renderer, text);
 					*text_it = text;
+					invalidate(range_of(*texture_it));
 					*texture_it = std::make_pair((*texture_it).first, texture);
+					invalidate(range_of(*texture_it));
+					update_bounds();
 					return texture;
 				}
 
@@ -92,8 +112,10 @@ namespace leap {
 				 * this also changes the iterators to the next element
 				 */
 				void erase(TextList::const_iterator &text_it, TextureList::const_iterator &texture_it) {
+					invalidate(range_of(*texture_it));
 					text_it = text_.erase(text_it);
 					texture_it = texture_.erase(texture_it);
+					update_bounds();
 				}
 				
 				StatusPtr status() const noexcept override {
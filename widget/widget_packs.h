@@ -4,4 +4,6 @@
 #include "base.hpp"
 #include "button.hpp"
 #include "text_box.hpp"
-#include "input_box.hpp"
\ No newline at end of file
+#include "input_box.hpp"
+#include "canvas.hpp"
+#include "layer.hpp"
\ No newline at end of file